@@ -1,5 +1,6 @@
 #include <ecs/ecs.h>
 #include "gbench/include/benchmark/benchmark.h"
+#include <array>
 #include <random>
 #include <numeric>
 #include <ranges>
@@ -24,19 +25,83 @@ void component_add_spans(benchmark::State& state) {
 }
 ECS_BENCHMARK(component_add_spans);
 
+// Loads components into a buffer, which is then adopted without copying
+void component_adopt_buffer(benchmark::State& state) {
+	auto const range = static_cast<std::size_t>(state.range(0));
+	auto const nentities = static_cast<int>(state.range(0));
+
+	for ([[maybe_unused]] auto const _ : state) {
+		ecs::unique_buffer<test_component_type> buffer(range + 1);
+		std::iota(buffer.data(), buffer.data() + range + 1, 9);
+
+		ecs::runtime ecs;
+		ecs.adopt_component_buffer({0, nentities}, std::move(buffer));
+		ecs.commit_changes();
+	}
+}
+ECS_BENCHMARK(component_adopt_buffer);
+
+// Loads components into a vector, which is then copied
+void component_add_spans_loaded(benchmark::State& state) {
+	auto const range = static_cast<std::size_t>(state.range(0));
+	auto const nentities = static_cast<int>(state.range(0));
+
+	for ([[maybe_unused]] auto const _ : state) {
+		std::vector<test_component_type> ints(range + 1);
+		std::iota(ints.begin(), ints.end(), 9);
+
+		ecs::runtime ecs;
+		ecs.add_component_span({0, nentities}, ints);
+		ecs.commit_changes();
+	}
+}
+ECS_BENCHMARK(component_add_spans_loaded);
+
 void component_add_generator(benchmark::State& state) {
 	auto const nentities = static_cast<int>(state.range(0));
 
 	for ([[maybe_unused]] auto const _ : state) {
 		ecs::runtime ecs;
-		ecs.add_component_generator({0, nentities}, [i = 0](ecs::entity_id ) mutable {
-			return i++;
+		ecs.add_component_generator({0, nentities}, [](ecs::entity_id id) {
+			return static_cast<test_component_type>(id);
 		});
 		ecs.commit_changes();
 	}
 }
 ECS_BENCHMARK(component_add_generator);
 
+// A generator that captures more state than fits in std::function's small buffer
+void component_add_generator_capturing(benchmark::State& state) {
+	auto const nentities = static_cast<int>(state.range(0));
+	std::array<test_component_type, 4> const offsets{1, 2, 3, 4};
+
+	for ([[maybe_unused]] auto const _ : state) {
+		ecs::runtime ecs;
+		ecs.add_component_generator({0, nentities}, [offsets](ecs::entity_id id) {
+			return static_cast<test_component_type>(id) + offsets[static_cast<std::size_t>(id) % offsets.size()];
+		});
+		ecs.commit_changes();
+	}
+}
+ECS_BENCHMARK(component_add_generator_capturing);
+
+// Many small generators, as when entities are populated one at a time
+void component_add_generator_small(benchmark::State& state) {
+	auto const nentities = static_cast<int>(state.range(0));
+	std::array<test_component_type, 4> const offsets{1, 2, 3, 4};
+
+	for ([[maybe_unused]] auto const _ : state) {
+		ecs::runtime ecs;
+		for (ecs::entity_id i = 0; i < nentities; i += 16) {
+			ecs.add_component_generator({i, i + 15}, [offsets](ecs::entity_id id) {
+				return static_cast<test_component_type>(id) + offsets[static_cast<std::size_t>(id) % offsets.size()];
+			});
+		}
+		ecs.commit_changes();
+	}
+}
+ECS_BENCHMARK(component_add_generator_small);
+
 void component_add(benchmark::State& state) {
 	auto const nentities = static_cast<int>(state.range(0));
 
@@ -48,6 +113,80 @@ void component_add(benchmark::State& state) {
 }
 ECS_BENCHMARK(component_add);
 
+// A trivially copyable component without an equality operator
+struct pod_component {
+	int x, y, z, w;
+};
+
+// Fills a value into the chunk in one go
+void component_add_pod(benchmark::State& state) {
+	auto const nentities = static_cast<int>(state.range(0));
+
+	for ([[maybe_unused]] auto const _ : state) {
+		ecs::runtime ecs;
+		ecs.add_component({0, nentities}, pod_component{1, 2, 3, 4});
+		ecs.commit_changes();
+	}
+}
+ECS_BENCHMARK(component_add_pod);
+
+// Copies a span into the chunk in one go
+void component_add_pod_spans(benchmark::State& state) {
+	auto const range = static_cast<std::size_t>(state.range(0));
+	auto const nentities = static_cast<int>(state.range(0));
+
+	std::vector<pod_component> pods(range + 1);
+	for (std::size_t i = 0; i < pods.size(); i++)
+		pods[i] = {static_cast<int>(i), 2, 3, 4};
+
+	for ([[maybe_unused]] auto const _ : state) {
+		ecs::runtime ecs;
+		ecs.add_component_span({0, nentities}, pods);
+		ecs.commit_changes();
+	}
+}
+ECS_BENCHMARK(component_add_pod_spans);
+
+// Adjacent adds of the same value are compared bytewise and merged into one chunk
+void component_add_pod_adjacent(benchmark::State& state) {
+	auto const nentities = static_cast<int>(state.range(0));
+
+	for ([[maybe_unused]] auto const _ : state) {
+		ecs::runtime ecs;
+		for (ecs::entity_id i = 0; i < nentities; i += 16)
+			ecs.add_component({i, i + 15}, pod_component{1, 2, 3, 4});
+		ecs.commit_changes();
+	}
+}
+ECS_BENCHMARK(component_add_pod_adjacent);
+
+// A single large burst of adds, which is constructed in parallel
+void component_add_burst(benchmark::State& state) {
+	auto const nentities = static_cast<int>(state.range(0));
+
+	for ([[maybe_unused]] auto const _ : state) {
+		ecs::runtime ecs;
+		ecs.add_component_generator({0, nentities}, [](ecs::entity_id id) {
+			return static_cast<test_component_type>(id);
+		});
+		ecs.commit_changes();
+	}
+}
+BENCHMARK(component_add_burst)->MeasureProcessCPUTime()->UseRealTime()->Arg(num_components);
+
+// Many small adds, which are sorted in parallel
+void component_add_burst_scattered(benchmark::State& state) {
+	auto const nentities = static_cast<int>(state.range(0));
+
+	for ([[maybe_unused]] auto const _ : state) {
+		ecs::runtime ecs;
+		for (ecs::entity_id i = nentities - 1; i >= 0; i -= 2)
+			ecs.add_component(i, test_component);
+		ecs.commit_changes();
+	}
+}
+BENCHMARK(component_add_burst_scattered)->MeasureProcessCPUTime()->UseRealTime()->Arg(num_components);
+
 void component_add_1k_blocks(benchmark::State& state) {
 	auto const nentities = static_cast<int>(state.range(0));
 
@@ -197,48 +336,82 @@ void component_add_randomized_remove(benchmark::State& state) {
 }
 ECS_BENCHMARK(component_add_randomized_remove);
 
-void find_component_data(benchmark::State& state) {
+struct indexed_int {
+	using ecs_flags = ecs::flags<ecs::indexed>;
+	int val;
+};
+
+// Looks up components in a pool that is fragmented into chunks of 8 entities,
+// in the order specified by 'make_ids'
+template <typename T>
+void find_component_data_impl(benchmark::State& state, auto make_ids) {
 	auto const nentities = static_cast<int>(state.range(0));
 
-	ecs::detail::component_pool<int> pool;
+	ecs::detail::component_pool<T> pool;
 
 	for (ecs::entity_id i = 0; i < nentities; i += 8) {
-		pool.add({i, i + 7}, int{});
+		pool.add({i, i + 7}, T{});
 		pool.process_changes();
 	}
 
+	std::vector<int> const ids = make_ids(nentities);
+
 	for ([[maybe_unused]] auto const _ : state) {
-		for (ecs::entity_id i = 0; i < nentities; ++i) {
-			auto* val = pool.find_component_data(i);
+		for (int const id : ids) {
+			auto* val = pool.find_component_data(id);
 			benchmark::DoNotOptimize(val);
 		}
 	}
 }
-ECS_BENCHMARK(find_component_data);
 
+std::vector<int> sequential_ids(int nentities) {
+	std::vector<int> ids(nentities);
+	std::iota(ids.begin(), ids.end(), 0);
+	return ids;
+}
 
-void find_component_data_random(benchmark::State& state) {
-	auto const nentities = static_cast<int>(state.range(0));
-
-	ecs::detail::component_pool<int> pool;
-
-	for (ecs::entity_id i = 0; i < nentities; i += 8) {
-		pool.add({i, i + 7}, int{});
-		pool.process_changes();
-	}
+std::vector<int> strided_ids(int nentities) {
+	// Visit every 13th entity, wrapping around, so each lookup lands in a different chunk
+	std::vector<int> ids(nentities);
+	for (int i = 0; i < nentities; ++i)
+		ids[i] = static_cast<int>((static_cast<long long>(i) * 13) % nentities);
+	return ids;
+}
 
+std::vector<int> random_ids(int nentities) {
 	std::random_device rd;
 	std::mt19937 g(rd());
-	std::vector<int> indices(nentities, 0);
-	std::iota(indices.begin(), indices.end(), 0);
-	std::ranges::shuffle(indices, g);
+	std::vector<int> ids = sequential_ids(nentities);
+	std::ranges::shuffle(ids, g);
+	return ids;
+}
 
-	for ([[maybe_unused]] auto const _ : state) {
-		for (ecs::entity_id i = 0; i < nentities; ++i) {
-			auto const id = indices[i];
-			auto* val = pool.find_component_data(id);
-			benchmark::DoNotOptimize(val);
-		}
-	}
+void find_component_data(benchmark::State& state) {
+	find_component_data_impl<int>(state, sequential_ids);
+}
+ECS_BENCHMARK(find_component_data);
+
+void find_component_data_strided(benchmark::State& state) {
+	find_component_data_impl<int>(state, strided_ids);
+}
+ECS_BENCHMARK(find_component_data_strided);
+
+void find_component_data_random(benchmark::State& state) {
+	find_component_data_impl<int>(state, random_ids);
 }
 ECS_BENCHMARK(find_component_data_random);
+
+void find_component_data_indexed(benchmark::State& state) {
+	find_component_data_impl<indexed_int>(state, sequential_ids);
+}
+ECS_BENCHMARK(find_component_data_indexed);
+
+void find_component_data_indexed_strided(benchmark::State& state) {
+	find_component_data_impl<indexed_int>(state, strided_ids);
+}
+ECS_BENCHMARK(find_component_data_indexed_strided);
+
+void find_component_data_indexed_random(benchmark::State& state) {
+	find_component_data_impl<indexed_int>(state, random_ids);
+}
+ECS_BENCHMARK(find_component_data_indexed_random);
@@ -137,3 +137,105 @@ void particles(benchmark::State& state) {
 	}
 }
 ECS_BENCHMARK(particles);
+
+// The same particle systems, but with the particle data stored as structures of arrays
+struct particle_soa { using ecs_flags = ecs::flags<ecs::soa>; float x, y; };
+struct color_soa    { using ecs_flags = ecs::flags<ecs::soa>; float r, g, b; };
+struct velocity_soa { using ecs_flags = ecs::flags<ecs::soa>; float x, y; };
+
+void make_soa_systems(ecs::runtime &ecs) {
+    // Apply gravity to the velocity
+    ecs.make_system([](ecs::soa_ref<velocity_soa> vel, gravity const& grav) { vel.get<1>() -= grav.g * delta_time; });
+
+    // Update a particles position from its velocity
+    ecs.make_system([](ecs::soa_ref<particle_soa> par, ecs::soa_ref<velocity_soa const> vel) {
+        auto [px, py] = par;
+        auto const [vx, vy] = vel;
+        px += vx * delta_time;
+        py += vy * delta_time;
+    });
+
+    // Make sure the particles stay within the bounds.
+    ecs.make_system([](ecs::soa_ref<particle_soa> par, ecs::soa_ref<velocity_soa> vel) {
+        auto [px, py] = par;
+        auto [vx, vy] = vel;
+
+        if (px > 1) {
+            px = 1;
+            float const p = 2 * vx * -1;
+            vx = vx - p * -1;
+        } else if (px < -1) {
+            px = -1;
+            float const p = 2 * vx * 1;
+            vx = vx - p * 1;
+        }
+
+        if (py > 1) {
+            py = 1;
+            float const p = 2 * vy * -1;
+            vy = vy - p * -1;
+        } else if (py < -1) {
+            py = -1;
+            float const p = 2 * vy * 1;
+            vy = vy - p * 1;
+        }
+    });
+
+    // Paint particles purple if they are in range of (0.0, 0.0)
+    ecs.make_system([](ecs::soa_ref<color_soa> col, ecs::soa_ref<particle_soa const> par) {
+        auto const [px, py] = par;
+        float const len_sqr = px * px + py * py;
+
+        if (len_sqr > 0.0005f)
+            return; // out of range
+
+        col = color_soa{1, 0, 1};
+    });
+
+    // Decrease life of live particles
+    ecs.make_system([&ecs](ecs::entity_id ent, life& l, dead_tag*) {
+        l.val -= delta_time;
+        if (l.val < 0) {
+            ecs.add_component(ent, dead_tag{});
+        }
+    });
+
+    // Necromance dead particles
+    ecs.make_system([](dead_tag, ecs::soa_ref<particle_soa> par, ecs::soa_ref<velocity_soa> vel, ecs::soa_ref<color_soa> col, life& l) {
+        auto const p = particle_init();
+        auto const v = velocity_init();
+        auto const c = color_init();
+        par = particle_soa{p.x, p.y};
+        vel = velocity_soa{v.x, v.y};
+        col = color_soa{c.r, c.g, c.b};
+        l = life_init();
+    });
+}
+
+void particles_soa(benchmark::State& state) {
+	auto const range = static_cast<std::size_t>(state.range(0));
+	auto const num_particles = static_cast<int>(state.range(0));
+
+	std::vector<particle_soa> particles(range + 1);
+	std::vector<velocity_soa> velocities(range + 1);
+	std::vector<color_soa> colors(range + 1);
+	std::vector<life> lifes(range + 1);
+
+	std::ranges::generate(particles, [] { auto const p = particle_init(); return particle_soa{p.x, p.y}; });
+	std::ranges::generate(velocities, [] { auto const v = velocity_init(); return velocity_soa{v.x, v.y}; });
+	std::ranges::generate(colors, [] { auto const c = color_init(); return color_soa{c.r, c.g, c.b}; });
+	std::ranges::generate(lifes, life_init);
+
+	ecs::runtime ecs;
+	make_soa_systems(ecs);
+	ecs.add_component_span({0, num_particles}, particles);
+	ecs.add_component_span({0, num_particles}, velocities);
+	ecs.add_component_span({0, num_particles}, colors);
+	ecs.add_component_span({0, num_particles}, lifes);
+	ecs.commit_changes();
+
+	for ([[maybe_unused]] auto const _ : state) {
+		ecs.update();
+	}
+}
+ECS_BENCHMARK(particles_soa);
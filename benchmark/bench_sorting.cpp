@@ -57,3 +57,34 @@ static void build_sorted_many_ranges(benchmark::State& state) {
 	//state.SetItemsProcessed(nentities * state.iterations());
 }
 ECS_BENCHMARK(build_sorted_many_ranges);
+
+static void run_sorted_few_modified(benchmark::State& state) {
+	auto const nentities = static_cast<int>(state.range(0));
+
+	std::vector<int> ints(static_cast<std::size_t>(1 + nentities));
+	std::iota(ints.begin(), ints.end(), 0);
+
+	std::random_device rd;
+	std::mt19937 gen{rd()};
+	std::shuffle(ints.begin(), ints.end(), gen);
+
+	ecs::runtime rt;
+	rt.add_component_span({0, nentities}, ints);
+
+	// 1% of the entities are written to each frame
+	rt.add_component({0, nentities / 100}, short{0});
+	rt.commit_changes();
+
+	auto& writer = rt.make_system<ecs::opts::manual_update, ecs::opts::not_parallel>([&gen](int& i, short const&) {
+		i = static_cast<int>(gen());
+	});
+	auto& sys = rt.make_system<ecs::opts::manual_update>([](int const&) {}, std::less<int>());
+	sys.run();
+
+	for ([[maybe_unused]] auto const _ : state) {
+		rt.commit_changes();
+		writer.run();
+		sys.run();
+	}
+}
+ECS_BENCHMARK(run_sorted_few_modified);
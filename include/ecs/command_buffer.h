@@ -0,0 +1,165 @@
+#ifndef ECS_COMMAND_BUFFER_H
+#define ECS_COMMAND_BUFFER_H
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "detail/command_list.h"
+#include "detail/component_pool.h"
+#include "detail/context.h"
+#include "detail/type_hash.h"
+#include "detail/verification.h"
+#include "entity_id.h"
+#include "entity_range.h"
+#include "flags.h"
+
+namespace ecs::detail {
+// The commands recorded for a type of component
+template <typename T>
+class command_list final : public command_list_base {
+	using pool_type = component_pool<T>;
+	using queued_component = typename pool_type::queued_component;
+
+	std::vector<queued_component> adds;
+	std::vector<entity_range> removes;
+
+public:
+	type_hash get_type_hash() const noexcept override {
+		return detail::get_type_hash<T>();
+	}
+
+	template <typename U>
+	void add(entity_range const range, U&& component) {
+		if constexpr (tagged<T>)
+			adds.emplace_back(range);
+		else
+			adds.emplace_back(range, std::forward<U>(component));
+	}
+
+	void remove(entity_range const range) {
+		removes.push_back(range);
+	}
+
+	void append(command_list_base& other) override {
+		auto& list = static_cast<command_list&>(other);
+		std::ranges::move(list.adds, std::back_inserter(adds));
+		std::ranges::move(list.removes, std::back_inserter(removes));
+		list.adds.clear();
+		list.removes.clear();
+	}
+
+	void submit(context& ctx) override {
+		pool_type& pool = ctx.get_component_pool<T>();
+
+		if (!removes.empty()) {
+			std::sort(removes.begin(), removes.end());
+			pool.remove_queued(std::move(removes));
+		}
+
+		if (!adds.empty()) {
+			std::sort(adds.begin(), adds.end(), [](queued_component const& l, queued_component const& r) {
+				return l.rng < r.rng;
+			});
+			pool.add_queued(std::move(adds));
+		}
+	}
+};
+} // namespace ecs::detail
+
+namespace ecs {
+// Records components to add to or remove from entities, without locking or touching the runtime.
+// Buffers can be filled from systems or worker threads, and handed to the runtime with 'runtime::submit'.
+// The commands are sorted once per type of component and applied in bulk by the next 'runtime::commit_changes()'.
+// NOTE: A command buffer must only be used by one thread at a time
+ECS_EXPORT class command_buffer {
+public:
+	// Records components to add to a range of entities
+	// Pre: entity does not already have the component, or have it in queue to be added
+	template <typename... T>
+	void add_component(entity_range const range, T&&... vals) {
+		static_assert(detail::is_unique_type_args<T...>(), "the same component type was specified more than once");
+		static_assert((!detail::global<T> && ...), "can not add global components to entities");
+		static_assert((!std::is_pointer_v<std::remove_cvref_t<T>> && ...), "can not add pointers to entities; wrap them in a struct");
+		static_assert((!detail::is_variant_of_pack<T...>()), "Can not add more than one component from the same variant");
+
+		auto const adder = [this, range]<typename Type>(Type&& val) {
+			using DerefT = std::remove_cvref_t<Type>;
+			if constexpr (detail::is_parent<DerefT>::value) {
+				get_list<detail::parent_id>().add(range, detail::parent_id{val.id()});
+			} else {
+				static_assert(std::is_constructible_v<DerefT, Type&&>, "Type must be copyable, or be moved into the command buffer");
+				Pre(std::copy_constructible<DerefT> || range.count() == 1, "move-only components can only be added to one entity at a time");
+				get_list<DerefT>().add(range, std::forward<Type>(val));
+			}
+			num_commands += 1;
+		};
+
+		(adder(std::forward<T>(vals)), ...);
+	}
+
+	// Records components to add to an entity
+	// Pre: entity does not already have the component, or have it in queue to be added
+	template <typename... T>
+	void add_component(entity_id const id, T&&... vals) {
+		add_component(entity_range{id, id}, std::forward<T>(vals)...);
+	}
+
+	// Records a component to remove from a range of entities
+	// Pre: entity has the component when the commands are applied
+	template <detail::persistent T>
+	void remove_component(entity_range const range, T const& = T{}) {
+		static_assert(!detail::global<T>, "can not remove or add global components to entities");
+		get_list<T>().remove(range);
+		num_commands += 1;
+	}
+
+	// Records a component to remove from an entity
+	// Pre: entity has the component when the commands are applied
+	template <typename T>
+	void remove_component(entity_id const id, T const& = T{}) {
+		remove_component<T>({id, id});
+	}
+
+	// Returns the number of recorded commands
+	std::size_t size() const noexcept {
+		return num_commands;
+	}
+
+	// Returns true if no commands are recorded
+	bool empty() const noexcept {
+		return 0 == num_commands;
+	}
+
+	// Removes all the recorded commands
+	void clear() noexcept {
+		lists.clear();
+		num_commands = 0;
+	}
+
+private:
+	friend class runtime;
+
+	// Returns the list of commands for a type, which is created the first time the type is used
+	template <typename T>
+	detail::command_list<T>& get_list() {
+		static constexpr auto hash = detail::get_type_hash<T>();
+		for (auto const& list : lists) {
+			if (list->get_type_hash() == hash)
+				return static_cast<detail::command_list<T>&>(*list);
+		}
+
+		lists.push_back(std::make_unique<detail::command_list<T>>());
+		return static_cast<detail::command_list<T>&>(*lists.back());
+	}
+
+	// The commands of each type, in the order the types were first used
+	std::vector<std::unique_ptr<detail::command_list_base>> lists;
+
+	// The number of recorded commands
+	std::size_t num_commands = 0;
+};
+} // namespace ecs
+
+#endif // !ECS_COMMAND_BUFFER_H
@@ -0,0 +1,22 @@
+#ifndef ECS_DEFRAGMENT_RESULT_H
+#define ECS_DEFRAGMENT_RESULT_H
+
+#include <cstddef>
+
+namespace ecs {
+// The result of defragmenting the components of a type
+ECS_EXPORT struct defragment_result {
+	// The number of chunks that were merged into other chunks
+	std::ptrdiff_t chunks_merged = 0;
+
+	// The number of bytes of component memory that was released
+	std::size_t bytes_reclaimed = 0;
+
+	// Returns true if any components were moved
+	explicit operator bool() const noexcept {
+		return chunks_merged > 0 || bytes_reclaimed > 0;
+	}
+};
+} // namespace ecs
+
+#endif // !ECS_DEFRAGMENT_RESULT_H
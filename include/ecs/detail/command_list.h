@@ -0,0 +1,30 @@
+#ifndef ECS_DETAIL_COMMAND_LIST_H
+#define ECS_DETAIL_COMMAND_LIST_H
+
+#include "type_hash.h"
+
+namespace ecs::detail {
+class context;
+
+// The commands recorded in a command buffer for a single type of component
+class command_list_base {
+public:
+	command_list_base() = default;
+	command_list_base(command_list_base const&) = delete;
+	command_list_base(command_list_base&&) = delete;
+	command_list_base& operator=(command_list_base const&) = delete;
+	command_list_base& operator=(command_list_base&&) = delete;
+	virtual ~command_list_base() = default;
+
+	// Returns the hash of the component type
+	virtual type_hash get_type_hash() const noexcept = 0;
+
+	// Moves the commands from another list of the same type to the end of this list
+	virtual void append(command_list_base& other) = 0;
+
+	// Sorts the commands and queues them in the component pool of the type
+	virtual void submit(context& ctx) = 0;
+};
+} // namespace ecs::detail
+
+#endif // !ECS_DETAIL_COMMAND_LIST_H
@@ -1,19 +1,32 @@
 #ifndef ECS_DETAIL_COMPONENT_POOL_H
 #define ECS_DETAIL_COMPONENT_POOL_H
 
+#include <algorithm>
+#include <cstring>
+#include <execution>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <memory_resource>
 #include <vector>
 #include <utility>
 #include <ranges>
 
 #include "tls/collect.h"
 
+#include "../defragment_result.h"
 #include "../entity_id.h"
 #include "../entity_range.h"
+#include "entity_range.h"
+#include "../soa_ref.h"
+#include "../unique_buffer.h"
+#include "deferred_generator.h"
 #include "parent_id.h"
 #include "tagged_pointer.h"
 #include "stride_view.h"
+#include "tag_bitset.h"
+#include "component_span_view.h"
+#include "type_hash.h"
 
 #include "component_pool_base.h"
 #include "../flags.h"
@@ -48,10 +61,17 @@ void combine_erase(Cont& cont, BinaryPredicate&& p) noexcept {
 	cont.erase(end, cont.end());
 }
 
-ECS_EXPORT template <typename T, typename Alloc = std::allocator<T>>
+ECS_EXPORT template <typename T, typename Alloc = std::pmr::polymorphic_allocator<T>>
 class component_pool final : public component_pool_base {
 private:
 	static_assert(!is_parent<T>::value, "can not have pools of any ecs::parent<type>");
+	static_assert(!(soa<T> && unbound<T>), "components flagged as 'soa' can not be 'tag's or 'global'");
+	static_assert(!(shared<T> && (unbound<T> || soa<T>)), "components flagged as 'share' can not be 'tag's, 'global', or 'soa'");
+	static_assert(!(double_buffered<T> && (unbound<T> || transient<T> || shared<T> || soa<T>)),
+				  "components flagged as 'double_buffer' can not be 'tag's, 'global', 'transient', 'share', or 'soa'");
+	static_assert(!double_buffered<T> || std::is_trivially_copyable_v<T>, "components flagged as 'double_buffer' must be trivially copyable");
+	static_assert(!(growable<T> && (unbound<T> || transient<T> || shared<T>)),
+				  "components flagged as 'grow' can not be 'tag's, 'global', 'transient', or 'share'");
 
 	struct chunk {
 		chunk() noexcept = default;
@@ -85,6 +105,7 @@ private:
 		// Tagged:
 		//   bit1 = owns data
 		//   bit2 = has split data
+		//   bit3 = has reserved data
 		tagged_pointer<T> data;
 
 		// Signals if this chunk owns this data and should clean it up
@@ -108,9 +129,45 @@ private:
 		bool get_has_split_data() const noexcept {
 			return data.test_bit2();
 		}
+
+		// Signals if this chunk took over the memory of a reservation
+		void set_has_reserved_data(bool reserved) noexcept {
+			if (reserved)
+				data.set_bit3();
+			else
+				data.clear_bit3();
+		}
+		bool get_has_reserved_data() const noexcept {
+			return data.test_bit3();
+		}
 	};
 	static_assert(sizeof(chunk) == 24);
 
+	// Trivially copyable components can be stored in snapshots as raw bytes.
+	// Transient components only live for a single cycle, so they are not stored.
+	static constexpr bool snapshot_supported = std::is_trivially_copyable_v<T> && !soa<T> && !transient<T>;
+
+	// The smallest alignment of chunk data that leaves room for the tag bits in 'chunk::data'
+	static constexpr std::size_t min_data_align = std::max(alignof(T), sizeof(void*));
+
+	// 'chunk::data' holds three tag bits, which needs 64-bit pointers and data aligned to at least 8 bytes
+	static_assert(sizeof(void*) >= 8 && min_data_align >= 8, "the tag bits in 'chunk::data' require a 64-bit platform");
+
+	// The alignment of chunk data, which can be raised by the components 'ecs_layout'
+	static constexpr std::size_t chunk_data_align = std::max(min_data_align, component_layout<T>::alignment);
+
+	// The number of components allocated for a chunk is rounded up to a multiple of this
+	static constexpr std::size_t chunk_data_padding = component_layout<T>::padding;
+
+	// Deferred adds are sorted in parallel when there are at least this many of them
+	static constexpr std::size_t parallel_sort_threshold = 8 * 1024;
+
+	// Components are constructed in parallel when a commit adds at least this many of them
+	static constexpr std::size_t parallel_construct_threshold = 16 * 1024;
+
+	// The number of components constructed by each parallel task
+	static constexpr std::size_t parallel_construct_block = 4 * 1024;
+
 	//
 	struct entity_empty {
 		entity_range rng;
@@ -125,32 +182,131 @@ private:
 		std::span<const T> data;
 		entity_span_member(entity_range r, std::span<const T> t) noexcept : entity_empty{r}, data(t) {}
 	};
+	struct entity_vector_member : entity_empty {
+		std::vector<T> data;
+		entity_vector_member(entity_range r, std::vector<T>&& t) noexcept : entity_empty{r}, data(std::move(t)) {}
+	};
+	struct entity_buffer_member : entity_empty {
+		unique_buffer<T> data;
+		entity_buffer_member(entity_range r, unique_buffer<T>&& t) noexcept : entity_empty{r}, data(std::move(t)) {}
+	};
 	struct entity_gen_member : entity_empty {
-		std::function<T(entity_id)> data;
-		entity_gen_member(entity_range r, std::function<T(entity_id)>&& t) noexcept
-			: entity_empty{r}, data(std::forward<std::function<T(entity_id)>>(t)) {}
+		deferred_generator<T> data;
+		bool parallel; // The generator can be called concurrently and out of order
+		template <typename Fn>
+		entity_gen_member(entity_range r, Fn&& t, bool p) : entity_empty{r}, data(std::forward<Fn>(t)), parallel(p) {}
 	};
 
 	using entity_data = std::conditional_t<unbound<T>, entity_empty, entity_data_member>;
 	using entity_span = std::conditional_t<unbound<T>, entity_empty, entity_span_member>;
+	using entity_vector = std::conditional_t<unbound<T>, entity_empty, entity_vector_member>;
+	using entity_buffer = std::conditional_t<unbound<T>, entity_empty, entity_buffer_member>;
 	using entity_gen = std::conditional_t<unbound<T>, entity_empty, entity_gen_member>;
 
+	// Components to construct in a chunk. The chunks are created first,
+	// so the components can be constructed in parallel afterwards.
+	template <typename U>
+	struct construct_job {
+		T* data;              // The chunks data
+		std::size_t count;    // The number of components in the chunks data
+		std::size_t offset;   // The offset of the first component to construct
+		entity_range range;   // The entities to construct components for
+		std::size_t index;    // The index of the first component in the deferred adds data
+		U* entry;             // The deferred add holding the component data
+		bool single;          // True if the deferred add is for a single entity, so its value is only used once
+	};
+
 	using chunk_iter = typename std::vector<chunk>::iterator;
 	using chunk_const_iter = typename std::vector<chunk>::const_iterator;
 
 	std::vector<chunk> chunks;
 	std::vector<component_pool_base*> variants;
 
+	// Paged lookup index, only used by 'indexed' components.
+	// Each page covers 'lookup_page_size' entities, starting at 'lookup_base', and
+	// holds the index of the first chunk whose active range ends at or after the page.
+	static constexpr entity_offset lookup_page_shift = 5;
+	static constexpr entity_offset lookup_page_size = 1u << lookup_page_shift;
+	std::vector<unsigned> lookup_pages;
+	entity_type lookup_base = 0;
+
+	// Bitset of the entities, only used by tag components whose entities are scattered over many chunks.
+	// It is built when there are at least 'tag_bitset_min_chunks' chunks, and the bitset has no more words than there are chunks.
+	static constexpr std::size_t tag_bitset_min_chunks = 64;
+	tag_bitset tag_bits;
+
+	// Chunk data adopted from buffers, and the deleters that release them
+	struct adopted_buffer {
+		T* data;
+		typename unique_buffer<T>::deleter_type deleter;
+	};
+	std::vector<adopted_buffer> adopted_data;
+
+	// Memory reserved for the components of entities that are added later. The first add that is
+	// contained in a reservation creates a chunk covering the whole reserved range.
+	struct reservation {
+		entity_range range;
+		T* data;
+	};
+	std::vector<reservation> reservations;
+
+	// The fragmentation at which the pool is defragmented automatically. Zero disables it.
+	float defrag_threshold = 0.0f;
+
+	// Memory for the chunks of transient components, which is reused every commit instead of
+	// allocating and freeing the chunks. If it runs out, the chunks are allocated separately
+	// and the arena is grown to fit all of them on the next commit.
+	std::byte* arena = nullptr;
+	std::size_t arena_size = 0;
+	std::size_t arena_used = 0;
+	std::size_t arena_overflow = 0;
+
+	// The number of chunks allocated for transient components, and how many of them reused the arena
+	std::size_t num_chunk_allocations = 0;
+	std::size_t num_arena_allocations = 0;
+
+	// The sorted ranges of components that have been added or written to since the last commit
+	std::vector<entity_range> modified_ranges;
+
+	// The sorted ranges of double-buffered components written to by systems since the last commit.
+	// Readers run alongside the writers, so the writes are not flagged until the buffers are flipped.
+	std::vector<entity_range> next_modified_ranges;
+
+	// The sorted ranges of components, and the version in which they were last added or written to.
+	// Unlike 'modified_ranges' these are kept across commits, until the components are removed.
+	struct versioned_range {
+		entity_range range;
+		std::uint64_t version;
+	};
+	std::vector<versioned_range> changed_ranges;
+
+	// The version of the latest change to the pool. Increases with every change, and is never reset.
+	std::uint64_t change_version = 0;
+
 	// Status flags
 	bool components_added : 1 = false;
 	bool components_removed : 1 = false;
-	bool components_modified : 1 = false;
 
 	// Keep track of which components to add/remove each cycle
 	[[MSVC no_unique_address]] tls::collect<std::vector<entity_data>, std::vector, component_pool<T>> deferred_adds;
 	[[MSVC no_unique_address]] tls::collect<std::vector<entity_span>, std::vector, component_pool<T>> deferred_spans;
+	[[MSVC no_unique_address]] tls::collect<std::vector<entity_vector>, std::vector, component_pool<T>> deferred_vectors;
+	[[MSVC no_unique_address]] tls::collect<std::vector<entity_buffer>, std::vector, component_pool<T>> deferred_buffers;
 	[[MSVC no_unique_address]] tls::collect<std::vector<entity_gen>, std::vector, component_pool<T>> deferred_gen;
 	[[MSVC no_unique_address]] tls::collect<std::vector<entity_range>, std::vector, component_pool<T>> deferred_removes;
+
+	// The ranges of destroyed entities. They are removed after the adds, so components added to the
+	// entities before they were destroyed are removed as well. Only written to under the context's pool lock.
+	std::vector<entity_range> destroyed_ranges;
+
+#if ECS_ENABLE_LOOKUP_STATS
+	// The number of single-entity lookups on each thread, and how many of them missed the cached chunk
+	struct lookup_counter {
+		std::size_t lookups = 0;
+		std::size_t misses = 0;
+	};
+	[[MSVC no_unique_address]] mutable tls::collect<lookup_counter, std::vector, component_pool<T>> lookup_counters;
+#endif
 #if ECS_ENABLE_CONTRACTS_AUDIT
 	[[MSVC no_unique_address]] tls::unique_collect<std::vector<entity_range>> deferred_variants;
 #endif
@@ -174,12 +330,21 @@ public:
 			chunks.clear();
 		} else {
 			free_all_chunks();
-			deferred_adds.clear();
+			release_reservations();
+			if constexpr (transient<T>)
+				release_arena();
+			clear_deferred(deferred_adds);
 			deferred_spans.clear();
-			deferred_gen.clear();
+			clear_deferred(deferred_vectors);
+			clear_deferred(deferred_buffers);
+			clear_deferred(deferred_gen);
 			deferred_removes.clear();
+			destroyed_ranges.clear();
 #if ECS_ENABLE_CONTRACTS_AUDIT
 			deferred_variants.clear();
+#endif
+#if ECS_ENABLE_LOOKUP_STATS
+			reset_lookup_counters();
 #endif
 		}
 	}
@@ -188,26 +353,71 @@ public:
 	// Pre: entities has not already been added, or is in queue to be added
 	//      This condition will not be checked until 'process_changes' is called.
 	// Pre: range and span must be same size.
-	void add_span(entity_range const range, std::span<const T> span) noexcept requires(!detail::unbound<T>) {
+	void add_span(entity_range const range, std::span<const T> span) noexcept requires(!detail::unbound<T> && std::copy_constructible<T>) {
 		//Pre(range.count() == std::ssize(span), "range and span must be same size");
 		remove_from_variants(range);
-		// Add the range and function to a temp storage
-		deferred_spans.local().emplace_back(range, span);
+		if constexpr (shared<T>) {
+			add_shared_runs(range, [&](entity_id const ent) -> T const& { return span[range.offset(ent)]; });
+		} else {
+			// Add the range and function to a temp storage
+			deferred_spans.local().emplace_back(range, span);
+		}
+	}
+
+	// Add a vector of components to a range of entities. The components are moved into the pool.
+	// Pre: entities has not already been added, or is in queue to be added
+	//      This condition will not be checked until 'process_changes' is called.
+	// Pre: range and vector must be same size.
+	void add_span(entity_range const range, std::vector<T>&& vec) noexcept requires(!detail::unbound<T>) {
+		remove_from_variants(range);
+		if constexpr (shared<T>) {
+			add_shared_runs(range, [&](entity_id const ent) -> T const& { return vec[range.offset(ent)]; });
+		} else {
+			deferred_vectors.local().emplace_back(range, std::move(vec));
+		}
 	}
 
-	// Add a component to a range of entities, initialized by the supplied user function generator
+	// Add a buffer of components to a range of entities. If possible, the memory of
+	// the buffer is used to store the components, otherwise they are moved out of it.
+	// Pre: entities has not already been added, or is in queue to be added
+	//      This condition will not be checked until 'process_changes' is called.
+	// Pre: range and buffer must be same size.
+	// Pre: the buffer must be aligned so the tag bits in 'chunk::data' are available.
+	void adopt(entity_range const range, unique_buffer<T>&& buffer) requires(!detail::unbound<T> && !soa<T> && !shared<T>) {
+		Pre(range.ucount() == buffer.size(), "range and buffer must be same size");
+		Pre(0 == reinterpret_cast<std::uintptr_t>(buffer.data()) % min_data_align, "buffer is not sufficiently aligned");
+		remove_from_variants(range);
+		deferred_buffers.local().emplace_back(range, std::move(buffer));
+	}
+
+	// Add a component to a range of entities, initialized by the supplied user function generator.
+	// The generator is called in order on one thread, unless 'parallel' is true.
 	// Pre: entities has not already been added, or is in queue to be added
 	//      This condition will not be checked until 'process_changes' is called.
 	template <typename Fn>
-	void add_generator(entity_range const range, Fn&& gen) {
+	void add_generator(entity_range const range, Fn&& gen, bool const parallel = false) {
 		remove_from_variants(range);
-		// Add the range and function to a temp storage
-		deferred_gen.local().emplace_back(range, std::forward<Fn>(gen));
+		if constexpr (shared<T>) {
+			// The values are needed to find the runs, so the generator is run right away
+			(void)parallel;
+			add_shared_runs(range, gen);
+		} else {
+			// Add the range and function to a temp storage
+			deferred_gen.local().emplace_back(range, std::forward<Fn>(gen), parallel);
+		}
+	}
+
+	// Changes the value of shared components. Runs that are partly covered by the range are split.
+	// Pre: the entities have the component, and it is not in queue to be removed
+	void assign(entity_range const range, T const& component) requires shared<T> {
+		deferred_removes.local().push_back(range);
+		deferred_adds.local().emplace_back(range, component);
 	}
 
 	// Add a component to a range of entity.
 	// Pre: entities has not already been added, or is in queue to be added
 	//      This condition will not be checked until 'process_changes' is called.
+	// Pre: move-only components can only be added to a single entity
 	void add(entity_range const range, T&& component) noexcept {
 		remove_from_variants(range);
 		if constexpr (tagged<T>) {
@@ -229,6 +439,231 @@ public:
 		}
 	}
 
+	// A component queued for a range of entities
+	using queued_component = entity_data;
+
+	// Queues a batch of components, like the ones recorded in a command buffer.
+	// Batches sorted by range are not sorted again when the changes are processed.
+	// Pre: entities has not already been added, or is in queue to be added
+	//      This condition will not be checked until 'process_changes' is called.
+	void add_queued(std::vector<queued_component>&& components) {
+		for (queued_component const& c : components)
+			remove_from_variants(c.rng);
+		append_queue(deferred_adds.local(), std::move(components));
+	}
+
+	// Queues a batch of entities to remove the component from
+	void remove_queued(std::vector<entity_range>&& ranges) {
+		append_queue(deferred_removes.local(), std::move(ranges));
+	}
+
+	// Allocates memory for the components of a range of entities, without adding any components.
+	// Components added to entities in the range are stored in the memory instead of in new chunks.
+	// A reservation is released if an add only partially overlaps it, or when the pool is cleared.
+	// Not thread safe; must not be called while changes are being processed.
+	// Pre: no entities in the range has the component, and the range is not already reserved
+	void reserve(entity_range const range) requires(!unbound<T> && !shared<T> && !transient<T>) {
+		PreAudit(std::ranges::none_of(chunks, [range](chunk const& c) { return c.range.overlaps(range); }),
+				 "entity already has a component of the type");
+		PreAudit(std::ranges::none_of(reservations, [range](reservation const& res) { return res.range.overlaps(range); }),
+				 "range is already reserved");
+		reservations.push_back({range, allocate_data(alloc, range.ucount())});
+	}
+
+	// Returns the number of entities that memory is reserved for
+	std::size_t num_reserved() const noexcept {
+		std::size_t count = 0;
+		for (reservation const& res : reservations)
+			count += res.range.ucount();
+		return count;
+	}
+
+	// Sets the memory resource used to allocate component data.
+	// Components already in the pool are moved to memory allocated from the new resource.
+	void set_memory_resource(std::pmr::memory_resource* resource) requires(std::same_as<Alloc, std::pmr::polymorphic_allocator<T>>) {
+		Pre(nullptr != resource, "memory resource can not be null");
+		if (resource->is_equal(*alloc.resource()))
+			return;
+
+		if constexpr (!unbound<T>) {
+			Alloc new_alloc{resource};
+
+			auto it = chunks.begin();
+			while (it != chunks.end()) {
+				// Chunks that share data are next to each other, so move them all in one go
+				T* const old_data = it->data.pointer();
+				entity_range const range = it->range;
+				T* const new_data = allocate_data(new_alloc, range.ucount());
+
+				for (; it != chunks.end() && it->data.pointer() == old_data; ++it) {
+					if constexpr (shared<T>) {
+						move_data(old_data, 1, 0, new_data, 1, 0, 1);
+					} else {
+						auto const offset = static_cast<std::size_t>(range.offset(it->active.first()));
+						move_data(old_data, range.ucount(), offset, new_data, range.ucount(), offset, it->active.ucount());
+					}
+					it->data = new_data;
+				}
+
+				release_data(old_data, range.ucount());
+			}
+
+			// Reservations hold no components, so they are just reallocated
+			for (reservation& res : reservations) {
+				deallocate_data(alloc, res.data, res.range.ucount());
+				res.data = allocate_data(new_alloc, res.range.ucount());
+			}
+
+			if constexpr (double_buffered<T>)
+				sync_back_buffers();
+		}
+
+		// The arena was allocated from the old resource
+		if constexpr (transient<T>)
+			release_arena();
+
+		// polymorphic_allocator can not be assigned to, so rebuild it in-place
+		std::destroy_at(&alloc);
+		std::construct_at(&alloc, resource);
+	}
+
+	// Returns the memory resource used to allocate component data
+	std::pmr::memory_resource* get_memory_resource() const noexcept requires(std::same_as<Alloc, std::pmr::polymorphic_allocator<T>>) {
+		return alloc.resource();
+	}
+
+	// Sets the fragmentation at which the pool is defragmented when changes are processed.
+	// A threshold of zero disables automatic defragmentation.
+	void set_defragment_threshold(float const threshold) noexcept {
+		Pre(threshold >= 0.0f && threshold <= 1.0f, "threshold must be in the range [0, 1]");
+		defrag_threshold = threshold;
+	}
+
+	// Returns the share of chunks that can be merged into the previous chunk,
+	// or that has memory not used by any entities. Growth capacity and reserved memory are not counted.
+	float get_fragmentation() const noexcept {
+		// Adjacent runs of shared components hold different values, so they can not be merged
+		if (chunks.empty() || shared<T>)
+			return 0.0f;
+
+		std::size_t fragments = 0;
+		for (std::size_t i = 0; i < chunks.size(); ++i) {
+			bool const mergeable = (i > 0) && chunks[i - 1].active.adjacent(chunks[i].active);
+			bool const unused = chunks[i].range != chunks[i].active && !is_growth_capacity(chunks[i]) && !is_reserved_capacity(chunks[i]);
+			fragments += (mergeable || unused);
+		}
+
+		return static_cast<float>(fragments) / static_cast<float>(chunks.size());
+	}
+
+	// Returns true if the unused memory of a chunk is only capacity for appending components to it
+	static bool is_growth_capacity(chunk const& c) noexcept {
+		if constexpr (growable<T>)
+			return c.range.first() == c.active.first() && c.get_owns_data() && !c.get_has_split_data();
+		else
+			return false;
+	}
+
+	// Returns true if the unused memory of a chunk is what is left of a reservation.
+	// Once the chunk is split, the memory is shared with other chunks and no longer counts as reserved.
+	static bool is_reserved_capacity(chunk const& c) noexcept {
+		return c.get_has_reserved_data() && c.get_owns_data() && !c.get_has_split_data();
+	}
+
+	// Returns the share of chunk allocations that reused memory from earlier commits
+	float get_memory_reuse_rate() const noexcept requires transient<T> {
+		if (num_chunk_allocations == 0)
+			return 0.0f;
+
+		return static_cast<float>(num_arena_allocations) / static_cast<float>(num_chunk_allocations);
+	}
+
+	// Returns the memory used by the pool
+	component_memory_report get_memory_report() override {
+		component_memory_report report;
+		report.name = get_type_name<T>();
+
+		if constexpr (global<T>) {
+			report.bytes_allocated = sizeof(T);
+			report.bytes_live = sizeof(T);
+			return report;
+		} else {
+			report.num_entities = num_entities();
+			report.num_chunks = num_chunks();
+			if (!chunks.empty())
+				report.average_run_length = static_cast<double>(report.num_entities) / static_cast<double>(report.num_chunks);
+
+			if constexpr (!tagged<T>) {
+				for (chunk const& c : chunks) {
+					// Split chunks use memory owned by an earlier chunk
+					if (!c.get_owns_data())
+						report.num_split_chunks += 1;
+					else if (!is_arena_data(c.data))
+						report.bytes_allocated += data_size(c.range.ucount());
+				}
+
+				for (reservation const& res : reservations)
+					report.bytes_allocated += data_size(res.range.ucount());
+
+				if constexpr (transient<T>)
+					report.bytes_allocated += arena_size;
+
+				report.bytes_live = static_cast<std::size_t>(num_components()) * sizeof(T);
+
+				// Each entity has both a current and a next component
+				if constexpr (double_buffered<T>)
+					report.bytes_live *= 2;
+			}
+
+			report.bytes_bookkeeping = chunks.capacity() * sizeof(chunk) + lookup_pages.capacity() * sizeof(unsigned) +
+									   tag_bits.memory_usage() + adopted_data.capacity() * sizeof(adopted_buffer) +
+									   (modified_ranges.capacity() + next_modified_ranges.capacity()) * sizeof(entity_range) +
+									   changed_ranges.capacity() * sizeof(versioned_range);
+
+			auto const add_deferred = [&report]<typename E>(std::vector<E>& queue) {
+				report.bytes_deferred += queue.capacity() * sizeof(E);
+			};
+			deferred_adds.for_each(add_deferred);
+			deferred_spans.for_each(add_deferred);
+			deferred_vectors.for_each(add_deferred);
+			deferred_buffers.for_each(add_deferred);
+			deferred_gen.for_each(add_deferred);
+			deferred_removes.for_each(add_deferred);
+			add_deferred(destroyed_ranges);
+
+#if ECS_ENABLE_LOOKUP_STATS
+			std::size_t lookups = 0;
+			std::size_t misses = 0;
+			lookup_counters.for_each([&](lookup_counter const& counter) {
+				lookups += counter.lookups;
+				misses += counter.misses;
+			});
+			if (lookups > 0)
+				report.lookup_hit_rate = static_cast<float>(lookups - misses) / static_cast<float>(lookups);
+#endif
+
+			return report;
+		}
+	}
+
+	// Merges chunks with adjacent entities into single allocations,
+	// and releases memory that is not used by any entities.
+	defragment_result defragment() requires(!global<T>) {
+		defragment_result const result = defragment_chunks();
+
+		if constexpr (indexed<T> && !unbound<T>) {
+			if (result.chunks_merged > 0)
+				rebuild_lookup_index();
+		}
+
+		if constexpr (double_buffered<T>) {
+			if (result)
+				sync_back_buffers();
+		}
+
+		return result;
+	}
+
 	// Adds a variant to this component pool
 	void add_variant(component_pool_base* variant) {
 		Pre(nullptr != variant, "variant can not be null");
@@ -253,54 +688,90 @@ public:
 
 	// Returns an entities component.
 	// Returns nullptr if the entity is not found in this pool
-	T* find_component_data(entity_id const id) noexcept requires(!global<T>) {
+	T* find_component_data(entity_id const id) noexcept requires(!global<T> && !soa<T>) {
 		return const_cast<T*>(std::as_const(*this).find_component_data(id));
 	}
 
 	// Returns an entities component.
 	// Returns nullptr if the entity is not found in this pool
-	T const* find_component_data(entity_id const id) const noexcept requires(!global<T>) {
-		if (chunks.empty())
+	T const* find_component_data(entity_id const id) const noexcept requires(!global<T> && !soa<T>) {
+		chunk const* const c = find_chunk(id);
+		if (nullptr == c)
 			return nullptr;
 
-		thread_local std::size_t tls_cached_chunk_index = 0;
-		auto chunk_index = tls_cached_chunk_index;
-		if (chunk_index >= std::size(chunks)) [[unlikely]] {
-			// Happens when component pools are reset
-			chunk_index = 0;
-		}
+		if constexpr (shared<T>)
+			return c->data.pointer();
+		else
+			return &c->data[c->range.offset(id)];
+	}
 
-		// Try the cached chunk index first. This will load 2 chunks into a cache line
-		if (!chunks[chunk_index].active.contains(id)) {
-			// Wasn't found at cached location, so try looking in next chunk.
-			// This should result in linear walks being very cheap.
-			if ((1+chunk_index) != std::size(chunks) && chunks[1+chunk_index].active.contains(id)) {
-				chunk_index += 1;
-				tls_cached_chunk_index = chunk_index;
-			} else {
-				// The id wasn't found in the cached chunks, so do a binary lookup
-				auto const range_it = find_in_ordered_active_ranges({id, id});
-				if (range_it != chunks.cend() && range_it->active.contains(id)) {
-					// cache the index
-					chunk_index = static_cast<std::size_t>(ranges_dist(range_it));
-					tls_cached_chunk_index = chunk_index;
-				} else {
-					return nullptr;
-				}
-			}
-		}
+	// Returns the next component of an entity, which becomes its current component in 'process_changes'.
+	// Returns nullptr if the entity is not found in this pool
+	T* find_next_component_data(entity_id const id) noexcept requires double_buffered<T> {
+		chunk const* const c = find_chunk(id);
+		if (nullptr == c)
+			return nullptr;
+
+		return &back_data(*c)[c->range.offset(id)];
+	}
+
+	// Returns the components of a range of entities, with one span for each run of components that are contiguous in memory.
+	// Returns an empty view if not all the entities in the range are found in this pool
+	component_span_view<T, chunk> get_component_spans(entity_range const range) const noexcept requires(!unbound<T> && !soa<T> && !shared<T>) {
+		return make_span_view(range, [](chunk const& c) noexcept { return const_cast<T*>(c.data.pointer()); });
+	}
+
+	// Returns the next components of a range of entities, with one span for each run of components that are contiguous in memory.
+	// Returns an empty view if not all the entities in the range are found in this pool
+	component_span_view<T, chunk> get_next_component_spans(entity_range const range) const noexcept requires double_buffered<T> {
+		return make_span_view(range, [](chunk const& c) noexcept { return back_data(c); });
+	}
+
+	// Returns a reference to the members of an entities component.
+	// Returns an empty reference if the entity is not found in this pool
+	soa_ref<T> find_component_ref(entity_id const id) noexcept requires(soa<T>) {
+		chunk const* const c = find_chunk(id);
+		if (nullptr == c)
+			return {};
 
-		// Do the lookup
-		auto const offset = chunks[chunk_index].range.offset(id);
-		return &chunks[chunk_index].data[offset];
+		return soa_access::make<T>(const_cast<T*>(c->data.pointer()), c->range.ucount(), static_cast<std::size_t>(c->range.offset(id)));
 	}
 
 	// Merge all the components queued for addition to the main storage,
 	// and remove components queued for removal
 	void process_changes() override {
+		modified_ranges.clear();
+
 		if constexpr (!global<T>) {
+			if constexpr (double_buffered<T>) {
+				flip_buffers();
+				notify_components_modified(next_modified_ranges);
+				next_modified_ranges.clear();
+			}
+
 			process_remove_components();
 			process_add_components();
+			if constexpr (!transient<T>)
+				process_destroyed_entities();
+
+			if (defrag_threshold > 0.0f && has_component_count_changed() && get_fragmentation() >= defrag_threshold)
+				defragment_chunks();
+
+			if constexpr (indexed<T> && !unbound<T>) {
+				if (has_component_count_changed())
+					rebuild_lookup_index();
+			}
+
+			if constexpr (tagged<T>) {
+				if (has_component_count_changed())
+					rebuild_tag_bitset();
+			}
+
+			// New and moved components need their next copy
+			if constexpr (double_buffered<T>) {
+				if (has_component_count_changed())
+					sync_back_buffers();
+			}
 		}
 	}
 
@@ -319,6 +790,8 @@ public:
 	ptrdiff_t num_components() const noexcept {
 		if constexpr (unbound<T>)
 			return 1;
+		else if constexpr (shared<T>)
+			return num_chunks();
 		else
 			return num_entities();
 	}
@@ -336,7 +809,6 @@ public:
 	void clear_flags() noexcept override {
 		components_added = false;
 		components_removed = false;
-		components_modified = false;
 	}
 
 	// Returns true if components has been added since last clear_flags() call
@@ -354,8 +826,43 @@ public:
 		return components_added || components_removed;
 	}
 
+	// Returns true if components has been added/removed since last clear_flags() call,
+	// or if any components has been added or written to since the last commit
 	bool has_components_been_modified() const noexcept {
-		return has_component_count_changed() || components_modified;
+		return has_component_count_changed() || !modified_ranges.empty();
+	}
+
+	// Returns the sorted ranges of components that have been added or written to since the last commit
+	entity_range_view get_modified_ranges() const noexcept {
+		return modified_ranges;
+	}
+
+	// Returns true if any components in the range has been added or written to since the last commit
+	bool is_modified(entity_range const range) const noexcept {
+		auto const it = std::ranges::lower_bound(modified_ranges, range.first(), std::less{}, &entity_range::last);
+		return it != modified_ranges.end() && it->overlaps(range);
+	}
+
+	// Returns the version of the latest change to the pool
+	std::uint64_t get_change_version() const noexcept {
+		return change_version;
+	}
+
+	// Moves the change version forward. Only used to test versions that do not fit in 32 bits
+	// Pre: the version is not older than the current one
+	void set_change_version(std::uint64_t const version) noexcept {
+		Pre(version >= change_version, "change versions can not go backwards");
+		change_version = version;
+	}
+
+	// Returns the sorted ranges of components that have been added or written to after 'version'
+	std::vector<entity_range> get_changed_ranges(std::uint64_t const version) const {
+		std::vector<entity_range> result;
+		for (versioned_range const& vr : changed_ranges) {
+			if (vr.version > version)
+				merge_or_add(result, vr.range);
+		}
+		return result;
 	}
 
 	// Returns the pools entities
@@ -366,6 +873,14 @@ public:
 			return {};
 	}
 
+	// Returns the bitset of the pools entities, or nullptr if the pool does not use one
+	tag_bitset const* get_tag_bitset() const noexcept {
+		if constexpr (tagged<T>)
+			return tag_bits.empty() ? nullptr : &tag_bits;
+		else
+			return nullptr;
+	}
+
 	// Returns true if an entity has a component in this pool
 	bool has_entity(entity_id const id) const noexcept {
 		return has_entity({id, id});
@@ -394,30 +909,182 @@ public:
 		return false;
 	}
 
+	// Returns true if any of the entities in the range are in the pool
+	bool has_any_entity(entity_range const range) const noexcept {
+		auto const it = find_in_ordered_active_ranges(range);
+		return it != chunks.end() && it->active.overlaps(range);
+	}
+
 	// Clear all entities from the pool
 	void clear() noexcept override {
-		// Remember if components was removed from the pool
-		bool const is_removed = (!chunks.empty());
+		// Remember if components was removed from the pool.
+		// The chunk of a global component is kept, as it is not bound to any entities.
+		bool const is_removed = !global<T> && !chunks.empty();
 
 		// Clear all data
 		free_all_chunks();
-		deferred_adds.clear();
+		release_reservations();
+		if constexpr (transient<T>)
+			reset_arena();
+		clear_deferred(deferred_adds);
 		deferred_spans.clear();
-		deferred_gen.clear();
+		clear_deferred(deferred_vectors);
+		clear_deferred(deferred_buffers);
+		clear_deferred(deferred_gen);
 		deferred_removes.clear();
-		chunks.clear();
+		destroyed_ranges.clear();
+		lookup_pages.clear();
+		tag_bits.clear();
+		modified_ranges.clear();
+		next_modified_ranges.clear();
+		changed_ranges.clear();
+#if ECS_ENABLE_LOOKUP_STATS
+		reset_lookup_counters();
+#endif
 		clear_flags();
 
 		// Save the removal state
 		components_removed = is_removed;
 	}
 
-	// Flag that components has been modified
-	void notify_components_modified() noexcept {
-		components_modified = true;
+	// Returns true if the components can be stored in snapshots
+	bool is_snapshot_supported() const noexcept override {
+		return snapshot_supported;
+	}
+
+	// Writes the components to a snapshot
+	// Pre: the components can be stored in snapshots
+	void save_snapshot(snapshot_writer& out) const override {
+		Pre(snapshot_supported, "the components can not be stored in snapshots");
+		if constexpr (snapshot_supported) {
+			out.write(std::uint64_t{sizeof(T)});
+
+			if constexpr (global<T>) {
+				out.write(std::uint64_t{0});
+				out.write(std::uint64_t{sizeof(T)});
+				out.write_bytes(chunks.front().data.pointer(), sizeof(T));
+			} else {
+				std::size_t num_bytes = 0;
+				if constexpr (!tagged<T>)
+					num_bytes = static_cast<std::size_t>(num_components()) * sizeof(T);
+
+				out.write(std::uint64_t{chunks.size()});
+				out.write(std::uint64_t{num_bytes});
+				for (chunk const& c : chunks) {
+					out.write(static_cast<entity_type>(c.active.first()));
+					out.write(static_cast<entity_type>(c.active.last()));
+				}
+
+				if constexpr (!tagged<T>) {
+					for (chunk const& c : chunks) {
+						if constexpr (shared<T>)
+							out.write_bytes(c.data.pointer(), sizeof(T));
+						else
+							out.write_bytes(&c.data[c.range.offset(c.active.first())], c.active.ucount() * sizeof(T));
+					}
+				}
+			}
+		}
+	}
+
+	// Reads the components from a snapshot. Adjacent runs are loaded into single chunks.
+	// Returns false if the snapshot data is not valid for this type of component.
+	// Pre: the pool is empty
+	bool load_snapshot(snapshot_reader& in) override {
+		if constexpr (!snapshot_supported) {
+			return false;
+		} else {
+			Pre(global<T> || chunks.empty(), "snapshots can only be loaded into empty pools");
+
+			std::uint64_t component_size = 0;
+			std::uint64_t num_runs = 0;
+			std::uint64_t num_bytes = 0;
+			if (!in.read(component_size) || !in.read(num_runs) || !in.read(num_bytes) || component_size != sizeof(T))
+				return false;
+
+			if constexpr (global<T>) {
+				return num_runs == 0 && num_bytes == sizeof(T) && in.read_bytes(chunks.front().data.pointer(), sizeof(T));
+			} else {
+				// Read the runs, and merge the adjacent ones. Runs of shared components hold different values, so they are kept apart.
+				std::vector<entity_range> runs;
+				std::uint64_t num_elements = 0;
+				for (std::uint64_t i = 0; i < num_runs; ++i) {
+					entity_type first = 0;
+					entity_type last = 0;
+					if (!in.read(first) || !in.read(last) || first > last)
+						return false;
+
+					entity_range const run{first, last};
+					if (!runs.empty() && runs.back().last() >= run.first())
+						return false;
+
+					if (!shared<T> && !runs.empty() && runs.back().adjacent(run))
+						runs.back() = entity_range::merge(runs.back(), run);
+					else
+						runs.push_back(run);
+
+					num_elements += shared<T> ? 1 : run.ucount();
+				}
+
+				if (num_bytes != (tagged<T> ? 0 : num_elements * sizeof(T)))
+					return false;
+
+				// Read the components directly into the chunks
+				chunks.reserve(runs.size());
+				for (entity_range const run : runs) {
+					T* data = nullptr;
+					if constexpr (!tagged<T>) {
+						std::size_t const count = shared<T> ? 1 : run.ucount();
+						data = allocate_data(alloc, run.ucount());
+						if (!in.read_bytes(data, count * sizeof(T))) {
+							deallocate_data(alloc, data, run.ucount());
+							return false;
+						}
+					}
+
+					create_new_chunk(chunks.end(), run, run, data);
+				}
+
+				if constexpr (double_buffered<T>)
+					sync_back_buffers();
+
+				notify_components_modified(runs);
+				if (!runs.empty())
+					set_data_added();
+				return true;
+			}
+		}
+	}
+
+	// Flag that the components in the sorted ranges has been modified
+	void notify_components_modified(entity_range_view const ranges) {
+		if (ranges.empty())
+			return;
+
+		union_ranges(modified_ranges, ranges);
+		set_range_versions(ranges, ++change_version);
+	}
+
+	// Flag that the next components in the sorted ranges has been modified.
+	// They are flagged as modified when the changes are processed.
+	void notify_next_components_modified(entity_range_view const ranges) requires double_buffered<T> {
+		union_ranges(next_modified_ranges, ranges);
+	}
+
+	// Flag that all components has been modified
+	void notify_components_modified() {
+		entity_range const all = entity_range::all();
+		notify_components_modified({&all, 1});
+	}
+
+	// Called from the context when entities are destroyed
+	// Removes the components of a range of entities, including components that are waiting to be added.
+	// Transient components are removed on the next commit anyway.
+	void remove_entities(entity_range const& range) override {
+		if constexpr (!global<T> && !transient<T>)
+			destroyed_ranges.push_back(range);
 	}
 
-	// Called from other component pools
 	void remove_variant(entity_range const& range) noexcept override {
 		deferred_removes.local().push_back(range);
 #if ECS_ENABLE_CONTRACTS_AUDIT
@@ -453,6 +1120,188 @@ private:
 		return true;
 	}
 
+	// Returns the number of bytes needed to store 'count' components, including the padding.
+	// Chunks of shared components only store a single component.
+	static constexpr std::size_t data_size(std::size_t count) noexcept {
+		if constexpr (soa<T>)
+			return soa_layout<T>::size(count);
+		else if constexpr (shared<T>)
+			return padded_count(1) * sizeof(T);
+		else if constexpr (double_buffered<T>)
+			return back_buffer_offset(count) + padded_count(count) * sizeof(T);
+		else
+			return padded_count(count) * sizeof(T);
+	}
+
+	// Returns the byte offset of the next components in a double-buffered chunk of 'count' components.
+	// The next components follow the current ones, and have the same alignment.
+	static constexpr std::size_t back_buffer_offset(std::size_t count) noexcept {
+		return (padded_count(count) * sizeof(T) + chunk_data_align - 1) / chunk_data_align * chunk_data_align;
+	}
+
+	// Returns the next components of a double-buffered chunk
+	static T* back_data(chunk const& c) noexcept requires double_buffered<T> {
+		auto* const bytes = reinterpret_cast<std::byte*>(const_cast<T*>(c.data.pointer()));
+		return reinterpret_cast<T*>(bytes + back_buffer_offset(c.range.ucount()));
+	}
+
+	// Makes the next components, written by systems since the last commit, the current components
+	void flip_buffers() noexcept requires double_buffered<T> {
+		for (chunk& c : chunks) {
+			auto const offset = c.range.offset(c.active.first());
+			std::memcpy(static_cast<void*>(c.data.pointer() + offset), back_data(c) + offset, c.active.ucount() * sizeof(T));
+		}
+	}
+
+	// Copies the current components to the next components
+	void sync_back_buffers() noexcept requires double_buffered<T> {
+		for (chunk& c : chunks) {
+			auto const offset = c.range.offset(c.active.first());
+			std::memcpy(static_cast<void*>(back_data(c) + offset), c.data.pointer() + offset, c.active.ucount() * sizeof(T));
+		}
+	}
+
+	// Returns the number of components allocated for a chunk of 'count' components
+	static constexpr std::size_t padded_count(std::size_t count) noexcept {
+		return (count + chunk_data_padding - 1) / chunk_data_padding * chunk_data_padding;
+	}
+
+	// Zeroes the padding after 'count' components
+	static void clear_padding([[maybe_unused]] T* data, [[maybe_unused]] std::size_t count) noexcept {
+		if constexpr (chunk_data_padding > 1) {
+			if constexpr (shared<T>)
+				count = 1;
+
+			std::memset(static_cast<void*>(data + count), 0, (padded_count(count) - count) * sizeof(T));
+			if constexpr (double_buffered<T>) {
+				T* const back = reinterpret_cast<T*>(reinterpret_cast<std::byte*>(data) + back_buffer_offset(count));
+				std::memset(static_cast<void*>(back + count), 0, (padded_count(count) - count) * sizeof(T));
+			}
+		}
+	}
+
+	// Allocates 'size' bytes. The memory is aligned so
+	// the tag bits in 'chunk::data' are always available.
+	static void* allocate_bytes(Alloc& a, std::size_t size) {
+		if constexpr (std::same_as<Alloc, std::pmr::polymorphic_allocator<T>>) {
+			return a.allocate_bytes(size, chunk_data_align);
+		} else {
+			// Other allocators are expected to return memory aligned like 'operator new' does
+			static_assert(chunk_data_align == min_data_align, "the alignment in 'ecs_layout' requires a polymorphic allocator");
+			return a.allocate((size + sizeof(T) - 1) / sizeof(T));
+		}
+	}
+
+	// Deallocates memory allocated with 'allocate_bytes'
+	static void deallocate_bytes(Alloc& a, void* data, std::size_t size) {
+		if constexpr (std::same_as<Alloc, std::pmr::polymorphic_allocator<T>>) {
+			a.deallocate_bytes(data, size, chunk_data_align);
+		} else {
+			a.deallocate(static_cast<T*>(data), (size + sizeof(T) - 1) / sizeof(T));
+		}
+	}
+
+	// Allocates data for 'count' components
+	static T* allocate_data(Alloc& a, std::size_t count) {
+		T* const data = static_cast<T*>(allocate_bytes(a, data_size(count)));
+		clear_padding(data, count);
+		return data;
+	}
+
+	// Deallocates data allocated with 'allocate_data'
+	static void deallocate_data(Alloc& a, T* data, std::size_t count) {
+		deallocate_bytes(a, data, data_size(count));
+	}
+
+	// Allocates data for the components of a new chunk.
+	// Transient components take the memory from the arena if it has room.
+	T* allocate_chunk_data(std::size_t count) {
+		if constexpr (transient<T>) {
+			num_chunk_allocations += 1;
+
+			std::size_t const size = data_size(count);
+			std::size_t const offset = (arena_used + chunk_data_align - 1) / chunk_data_align * chunk_data_align;
+			if (offset + size <= arena_size) {
+				num_arena_allocations += 1;
+				arena_used = offset + size;
+
+				T* const data = reinterpret_cast<T*>(arena + offset);
+				clear_padding(data, count);
+				return data;
+			}
+
+			// Make room for it in the arena on the next commit
+			arena_overflow += size + chunk_data_align;
+		}
+
+		return allocate_data(alloc, count);
+	}
+
+	// Returns true if the data is in the arena
+	bool is_arena_data(T const* data) const noexcept {
+		auto const* const ptr = reinterpret_cast<std::byte const*>(data);
+		std::less<std::byte const*> const less;
+		return nullptr != arena && !less(ptr, arena) && less(ptr, arena + arena_size);
+	}
+
+	// Makes the arena available for the next commit, and grows it if it ran out of room.
+	// Pre: no chunks are using the arena
+	void reset_arena() requires transient<T> {
+		if (arena_overflow > 0) {
+			std::size_t const new_size = arena_used + arena_overflow;
+			release_arena();
+			arena = static_cast<std::byte*>(allocate_bytes(alloc, new_size));
+			arena_size = new_size;
+		}
+
+		arena_used = 0;
+		arena_overflow = 0;
+	}
+
+	// Frees the arena
+	// Pre: no chunks are using the arena
+	void release_arena() noexcept requires transient<T> {
+		if (nullptr != arena)
+			deallocate_bytes(alloc, arena, arena_size);
+
+		arena = nullptr;
+		arena_size = 0;
+		arena_used = 0;
+	}
+
+	// Releases chunk data, which is either allocated by the pool, adopted from a buffer, or in the arena
+	void release_data(T* data, std::size_t count) noexcept {
+		if constexpr (transient<T>) {
+			// The arena is reused as a whole
+			if (is_arena_data(data))
+				return;
+		}
+
+		if (!adopted_data.empty()) {
+			auto const it = std::ranges::find(adopted_data, data, &adopted_buffer::data);
+			if (it != adopted_data.end()) {
+				it->deleter(data, count);
+				adopted_data.erase(it);
+				return;
+			}
+		}
+
+		deallocate_data(alloc, data, count);
+	}
+
+	// Moves 'num' components between two allocations holding 'from_count' and 'to_count' components
+	static void move_data(T* from, std::size_t from_count, std::size_t from_index,
+						  T* to, std::size_t to_count, std::size_t to_index, std::size_t num) noexcept {
+		if constexpr (soa<T>) {
+			soa_layout<T>::copy(from, from_count, from_index, to, to_count, to_index, num);
+		} else {
+			(void)from_count;
+			(void)to_count;
+			std::uninitialized_move_n(from + from_index, num, to + to_index);
+			std::destroy_n(from + from_index, num);
+		}
+	}
+
 	chunk_iter create_new_chunk(chunk_iter it_loc, entity_range const range, entity_range const active, T* data = nullptr,
 								bool owns_data = true, bool split_data = false) noexcept {
 		Pre(range.contains(active), "active range is not contained in the total range");
@@ -460,17 +1309,67 @@ private:
 	}
 
 	template <typename U>
-	chunk_iter create_new_chunk(chunk_iter loc, typename std::vector<U>::const_iterator const& iter) noexcept {
+	chunk_iter create_new_chunk(chunk_iter loc, typename std::vector<U>::iterator const& iter, [[maybe_unused]] entity_id const entry_first,
+								[[maybe_unused]] std::vector<construct_job<U>>& jobs) noexcept {
 		entity_range const r = iter->rng;
 		chunk_iter c = create_new_chunk(loc, r, r);
 		if constexpr (!unbound<T>) {
-			c->data = alloc.allocate(r.ucount());
-			construct_range_in_chunk(c, r, iter->data);
+			// Use reserved memory if the range was reserved
+			if (!reservations.empty() && claim_reservation(c)) {
+				add_construct_job(jobs, c, r, *iter, entry_first);
+				return c;
+			}
+
+			if constexpr (std::is_same_v<U, entity_buffer> && chunk_data_padding == 1 && !double_buffered<T>) {
+				// Use the memory of a whole buffer directly, if it satisfies the components layout
+				bool const aligned = 0 == reinterpret_cast<std::uintptr_t>(iter->data.data()) % chunk_data_align;
+				if (aligned && r.first() == entry_first && r.ucount() == iter->data.size()) {
+					T* const data = iter->data.data();
+					adopted_data.push_back({data, iter->data.release()});
+					c->data = data;
+					return c;
+				}
+			}
+
+			c->data = allocate_chunk_data(r.ucount());
+			add_construct_job(jobs, c, r, *iter, entry_first);
 		}
 
 		return c;
 	}
 
+	// Hands a reservation containing the range of a new chunk over to the chunk, which is then grown to the reserved range.
+	// Reservations only partially overlapping the chunk are released, so they never overlap the range of a chunk.
+	// Returns true if the chunk took over a reservation.
+	bool claim_reservation(chunk_iter c) noexcept {
+		bool claimed = false;
+		auto it = reservations.begin();
+		while (it != reservations.end()) {
+			if (!it->range.overlaps(c->range)) {
+				++it;
+				continue;
+			}
+
+			if (it->range.contains(c->range)) {
+				c->range = it->range;
+				c->data = it->data;
+				c->set_has_reserved_data(true);
+				claimed = true;
+			} else {
+				release_data(it->data, it->range.ucount());
+			}
+			it = reservations.erase(it);
+		}
+		return claimed;
+	}
+
+	// Frees the memory of all reservations
+	void release_reservations() noexcept {
+		for (reservation const& res : reservations)
+			release_data(res.data, res.range.ucount());
+		reservations.clear();
+	}
+
 	void free_chunk_data(chunk_iter c) noexcept {
 		// Check for potential ownership transfer
 		if (c->get_owns_data()) {
@@ -481,11 +1380,14 @@ private:
 				next->set_owns_data(true);
 			} else {
 				if constexpr (!unbound<T>) {
-					// Destroy active range
-					std::destroy_n(c->data.pointer(), c->active.ucount());
+					// Destroy active range. The members of 'soa' components are trivially destructible
+					if constexpr (shared<T>)
+						std::destroy_at(c->data.pointer());
+					else if constexpr (!soa<T>)
+						std::destroy_n(c->data.pointer(), c->active.ucount());
 
 					// Free entire range
-					alloc.deallocate(c->data.pointer(), c->range.ucount());
+					release_data(c->data.pointer(), c->range.ucount());
 
 					// Debug
 					c->data.clear();
@@ -512,6 +1414,195 @@ private:
 		}
 	}
 
+	// Merges chunks and releases unused memory. Does not update the lookup index.
+	defragment_result defragment_chunks() requires(!global<T>) {
+		// Runs of shared components are merged when they are added, and never have unused memory
+		if constexpr (shared<T>)
+			return {};
+
+		std::vector<chunk> new_chunks;
+		new_chunks.reserve(chunks.size());
+
+		// Old allocations are freed after all the components have been moved,
+		// because split chunks share them
+		std::vector<std::pair<T*, std::size_t>> old_data;
+		std::size_t bytes_allocated = 0;
+
+		auto it = chunks.begin();
+		while (it != chunks.end()) {
+			// Find the chunks with adjacent entities
+			auto last = std::next(it);
+			while (last != chunks.end() && std::prev(last)->active.adjacent(last->active))
+				std::advance(last, 1);
+
+			if (std::next(it) == last && it->range == it->active) {
+				// Nothing to merge or release
+				Assert(it->get_owns_data(), "internal: chunk does not own its data; create an issue on Github and investigate");
+				new_chunks.push_back(std::move(*it));
+			} else {
+				entity_range const merged{it->active.first(), std::prev(last)->active.last()};
+				T* data = nullptr;
+
+				if constexpr (!unbound<T>) {
+					data = allocate_data(alloc, merged.ucount());
+					bytes_allocated += data_size(merged.ucount());
+
+					for (auto c = it; c != last; ++c) {
+						move_data(c->data.pointer(), c->range.ucount(), static_cast<std::size_t>(c->range.offset(c->active.first())),
+								  data, merged.ucount(), static_cast<std::size_t>(merged.offset(c->active.first())), c->active.ucount());
+
+						if (c->get_owns_data())
+							old_data.emplace_back(c->data.pointer(), c->range.ucount());
+					}
+				}
+
+				new_chunks.emplace_back(merged, merged, data, true, false);
+			}
+
+			it = last;
+		}
+
+		std::size_t bytes_freed = 0;
+		for (auto const& [data, count] : old_data) {
+			release_data(data, count);
+			bytes_freed += data_size(count);
+		}
+		Assert(bytes_freed >= bytes_allocated, "internal: defragmenting used more memory; create an issue on Github and investigate");
+
+		defragment_result const result{std::ssize(chunks) - std::ssize(new_chunks), bytes_freed - bytes_allocated};
+		chunks = std::move(new_chunks);
+		return result;
+	}
+
+#if ECS_ENABLE_LOOKUP_STATS
+	// Resets the lookup counters on all threads
+	void reset_lookup_counters() noexcept {
+		lookup_counters.for_each([](lookup_counter& counter) { counter = {}; });
+	}
+#endif
+
+	// Returns the chunk holding an entities component.
+	// Returns nullptr if the entity is not found in this pool
+	chunk const* find_chunk(entity_id const id) const noexcept requires(!global<T>) {
+		if (chunks.empty())
+			return nullptr;
+
+#if ECS_ENABLE_LOOKUP_STATS
+		// Lookups through the paged index do not use the cache, so they always count as hits
+		lookup_counter& counter = lookup_counters.local();
+		counter.lookups += 1;
+#endif
+
+		if constexpr (indexed<T>) {
+			if (!lookup_pages.empty())
+				return find_chunk_indexed(id);
+		}
+
+		thread_local std::size_t tls_cached_chunk_index = 0;
+		auto chunk_index = tls_cached_chunk_index;
+		if (chunk_index >= std::size(chunks)) [[unlikely]] {
+			// Happens when component pools are reset
+			chunk_index = 0;
+		}
+
+		// Try the cached chunk index first. This will load 2 chunks into a cache line
+		if (!chunks[chunk_index].active.contains(id)) {
+			// Wasn't found at cached location, so try looking in next chunk.
+			// This should result in linear walks being very cheap.
+			if ((1+chunk_index) != std::size(chunks) && chunks[1+chunk_index].active.contains(id)) {
+				chunk_index += 1;
+				tls_cached_chunk_index = chunk_index;
+			} else {
+				// The id wasn't found in the cached chunks, so do a binary lookup
+#if ECS_ENABLE_LOOKUP_STATS
+				counter.misses += 1;
+#endif
+				auto const range_it = find_in_ordered_active_ranges({id, id});
+				if (range_it != chunks.cend() && range_it->active.contains(id)) {
+					// cache the index
+					chunk_index = static_cast<std::size_t>(ranges_dist(range_it));
+					tls_cached_chunk_index = chunk_index;
+				} else {
+					return nullptr;
+				}
+			}
+		}
+
+		return &chunks[chunk_index];
+	}
+
+	// Finds an entities chunk using the paged lookup index
+	// Pre: the lookup index has been built
+	chunk const* find_chunk_indexed(entity_id const id) const noexcept requires(indexed<T>) {
+		// Ids below 'lookup_base' wrap around to very large pages, so they fail the bounds check as well
+		auto const page = (static_cast<entity_offset>(id) - static_cast<entity_offset>(lookup_base)) >> lookup_page_shift;
+		if (page >= lookup_pages.size())
+			return nullptr;
+
+		// Walk forward from the first chunk in the page. Bounded by the page size.
+		std::size_t chunk_index = lookup_pages[page];
+		while (chunk_index < chunks.size() && chunks[chunk_index].active.last() < id)
+			chunk_index += 1;
+
+		if (chunk_index == chunks.size() || !chunks[chunk_index].active.contains(id))
+			return nullptr;
+
+		return &chunks[chunk_index];
+	}
+
+	// Rebuilds the paged lookup index from the current chunks.
+	// If the entities are too sparse, the index is left empty and lookups fall back to a binary search.
+	void rebuild_lookup_index() requires(indexed<T>) {
+		lookup_pages.clear();
+		if (chunks.empty())
+			return;
+
+		lookup_base = chunks.front().active.first();
+		entity_offset const id_span = static_cast<entity_offset>(chunks.back().active.last()) - static_cast<entity_offset>(lookup_base);
+		std::size_t const num_pages = 1 + (id_span >> lookup_page_shift);
+
+		// Don't let the index grow much larger than the data it indexes
+		std::size_t const max_pages = 8 * (chunks.size() + static_cast<std::size_t>(num_entities()) / lookup_page_size);
+		if (num_pages > max_pages)
+			return;
+
+		lookup_pages.resize(num_pages);
+		unsigned chunk_index = 0;
+		entity_offset page_first = static_cast<entity_offset>(lookup_base);
+		for (unsigned& page : lookup_pages) {
+			while (chunks[chunk_index].active.last() < static_cast<entity_type>(page_first))
+				chunk_index += 1;
+
+			page = chunk_index;
+			page_first += lookup_page_size;
+		}
+	}
+
+	// Rebuilds the bitset of the entities from the current chunks.
+	// If the entities are in few or large chunks, the bitset is left empty.
+	void rebuild_tag_bitset() requires(tagged<T>) {
+		tag_bits.clear();
+		if (chunks.size() < tag_bitset_min_chunks)
+			return;
+
+		entity_offset const id_span = static_cast<entity_offset>(chunks.back().active.last()) - static_cast<entity_offset>(chunks.front().active.first());
+		std::size_t const num_words = 1 + id_span / 64;
+		if (num_words > chunks.size())
+			return;
+
+		tag_bits.build(get_entities());
+	}
+
+	// Returns a view of the chunks holding a range of entities
+	component_span_view<T, chunk> make_span_view(entity_range const range, typename component_span_view<T, chunk>::get_data_fn get_data) const noexcept {
+		if (!has_entity(range))
+			return {};
+
+		auto const first = find_in_ordered_active_ranges(range);
+		auto const last = std::next(find_in_ordered_active_ranges({range.last(), range.last()}));
+		return {std::to_address(first), std::to_address(last), range, get_data};
+	}
+
 	auto find_in_ordered_active_ranges(entity_range const rng) const noexcept {
 		return std::ranges::lower_bound(chunks, rng, std::less{}, &chunk::active);
 	}
@@ -533,6 +1624,53 @@ private:
 		}
 	}
 
+	// Sets the version of the components in the sorted ranges.
+	// Components set to version zero are no longer tracked.
+	void set_range_versions(entity_range_view const ranges, std::uint64_t const version) {
+		if (ranges.empty())
+			return;
+
+		std::vector<versioned_range> result;
+		result.reserve(changed_ranges.size() + ranges.size() + 1);
+
+		auto const add = [&result](entity_range const r, std::uint64_t const v) {
+			if (v == 0)
+				return;
+
+			if (!result.empty() && result.back().version == v && result.back().range.last() + 1 == r.first())
+				result.back().range = entity_range::merge(result.back().range, r);
+			else
+				result.push_back({r, v});
+		};
+
+		auto it = changed_ranges.begin();
+		for (entity_range const r : ranges) {
+			// Keep the ranges before 'r'
+			for (; it != changed_ranges.end() && it->range.last() < r.first(); ++it)
+				add(it->range, it->version);
+
+			// Keep the parts of the ranges that are not covered by 'r'
+			for (; it != changed_ranges.end() && it->range.first() <= r.last(); ++it) {
+				if (it->range.first() < r.first())
+					add({it->range.first(), r.first() - 1}, it->version);
+
+				if (it->range.last() > r.last()) {
+					// The remainder might overlap the next 'r'
+					it->range = {r.last() + 1, it->range.last()};
+					break;
+				}
+			}
+
+			add(r, version);
+		}
+
+		// Keep the ranges after the last 'r'
+		for (; it != changed_ranges.end(); ++it)
+			add(it->range, it->version);
+
+		changed_ranges = std::move(result);
+	}
+
 	// Flag that components has been added
 	void set_data_added() noexcept {
 		components_added = true;
@@ -550,29 +1688,147 @@ private:
 		// Tags are empty, so always return true
 		return true;
 	}
+	static bool is_equal(T const& lhs, T const& rhs) noexcept requires(!std::equality_comparable<T> && !tagged<T> && std::has_unique_object_representations_v<T>) {
+		// Types without padding are equal if their bytes are equal
+		return 0 == std::memcmp(&lhs, &rhs, sizeof(T));
+	}
 	static bool is_equal(T const&, T const&) noexcept {
 		// Type can not be compared, so always return false.
-		// memcmp is a no-go because it also compares padding in types,
-		// and it is not constexpr
+		// memcmp is a no-go because it also compares padding in types
 		return false;
 	}
 
-	template <typename Data>
-	void construct_range_in_chunk(chunk_iter c, entity_range range, Data const& comp_data) noexcept requires(!unbound<T>) {
-		// Offset into the chunks data
-		auto const ent_offset = c->range.offset(range.first());
+	// Appends a batch of entries to a queue. Empty queues take over the batch
+	template <typename E>
+	static void append_queue(std::vector<E>& queue, std::vector<E>&& entries) {
+		if (queue.empty())
+			queue = std::move(entries);
+		else
+			std::ranges::move(entries, std::back_inserter(queue));
+	}
+
+	// Clears deferred adds. 'tls::collect::clear' assigns an empty initializer list to the data,
+	// which requires copyable entries. Entries holding vectors of move-only components
+	// also count as copyable, so the component type is checked as well.
+	template <typename E, typename D>
+	static void clear_deferred(tls::collect<std::vector<E>, std::vector, D>& deferred) {
+		if constexpr (std::copy_constructible<E> && std::copy_constructible<T>)
+			deferred.clear();
+		else
+			deferred.for_each([](std::vector<E>& vec) { vec.clear(); });
+	}
+
+	template <typename U>
+	static void add_construct_job(std::vector<construct_job<U>>& jobs, chunk_iter c, entity_range range, U& entry, entity_id const entry_first) noexcept {
+		auto const offset = static_cast<std::size_t>(c->range.offset(range.first()));
+		auto const index = static_cast<std::size_t>(range.first() - entry_first);
+		// The range of the entry shrinks from the front as it is split over chunks, so its last entity is unchanged
+		bool const single = entry.rng.last() == entry_first;
+		jobs.push_back({c->data.pointer(), c->range.ucount(), offset, range, index, &entry, single});
+	}
 
-		entity_id ent = range.first();
-		for (size_t i = 0; i < range.ucount(); ++i, ++ent) {
-			// Construct from a value or a a span of values
-			if constexpr (std::is_same_v<T, Data>) {
-				std::construct_at(&c->data[ent_offset + i], comp_data);
-			} else if constexpr (std::is_invocable_v<Data, entity_id>) {
-				std::construct_at(&c->data[ent_offset + i], comp_data(ent));
+	// Constructs the components in [first, last) of a jobs range
+	template <typename U>
+	static void construct_components(construct_job<U> const& job, std::size_t const first, std::size_t const last) noexcept requires(!unbound<T>) {
+		auto& comp_data = job.entry->data;
+		using Data = std::remove_cvref_t<decltype(comp_data)>;
+
+		// Constructs the components from the values returned by 'get_value'
+		auto const construct = [&job, first, last](auto&& get_value) {
+			entity_id ent = job.range.first() + static_cast<entity_type>(first);
+			if constexpr (soa<T>) {
+				// Write the members into their arrays
+				soa_ref<T> const base = soa_access::make<T>(job.data, job.count, job.offset);
+				for (size_t i = first; i < last; ++i, ++ent) {
+					soa_access::advance(base, static_cast<std::ptrdiff_t>(i)) = get_value(i, ent);
+				}
 			} else {
-				std::construct_at(&c->data[ent_offset + i], comp_data[i]);
+				for (size_t i = first; i < last; ++i, ++ent) {
+					std::construct_at(&job.data[job.offset + i], get_value(i, ent));
+				}
+			}
+		};
+
+		// Trivially copyable components are filled or copied in bulk
+		constexpr bool bulk_copy = !soa<T> && std::is_trivially_copyable_v<T>;
+
+		// Get the components from a value, a generator, or a span of values
+		if constexpr (std::is_same_v<T, Data>) {
+			if constexpr (std::copy_constructible<T>) {
+				if (!job.single) {
+					if constexpr (bulk_copy)
+						std::uninitialized_fill_n(&job.data[job.offset + first], last - first, comp_data);
+					else
+						construct([&comp_data](size_t, entity_id) -> T const& { return comp_data; });
+					return;
+				}
+			}
+
+			// A value added to a single entity is only used once, so it is moved into the chunk
+			construct([&comp_data](size_t, entity_id) -> T&& { return std::move(comp_data); });
+		} else if constexpr (std::is_same_v<deferred_generator<T>, Data>) {
+			// The generator constructs the whole block itself
+			entity_id const ent = job.range.first() + static_cast<entity_type>(first);
+			comp_data.generate(job.data, job.count, job.offset + first, ent, last - first);
+		} else if constexpr (bulk_copy) {
+			// Moving a trivially copyable component is the same as copying it
+			std::memcpy(&job.data[job.offset + first], comp_data.data() + job.index + first, (last - first) * sizeof(T));
+		} else if constexpr (std::is_same_v<std::vector<T>, Data> || std::is_same_v<unique_buffer<T>, Data>) {
+			// Each element of a vector or buffer is only used once, so it is moved into the chunk
+			construct([&comp_data, &job](size_t const i, entity_id) -> T&& { return std::move(comp_data.data()[job.index + i]); });
+		} else {
+			construct([&comp_data, &job](size_t const i, entity_id) -> T const& { return comp_data[job.index + i]; });
+		}
+	}
+
+	// Returns true if the components of a job can be constructed in parallel.
+	// Generators are only called in parallel if they were added for that.
+	template <typename U>
+	static bool is_parallel_job(construct_job<U> const& job) noexcept {
+		if constexpr (std::is_same_v<U, entity_gen>)
+			return job.entry->parallel;
+		else
+			return true;
+	}
+
+	// Constructs the components of all the jobs. Large batches are split into blocks
+	// that are constructed in parallel.
+	template <typename U>
+	static void run_construct_jobs(std::vector<construct_job<U>> const& jobs) noexcept requires(!unbound<T>) {
+		std::size_t total = 0;
+		for (construct_job<U> const& job : jobs) {
+			if (is_parallel_job(job))
+				total += job.range.ucount();
+			else
+				construct_components(job, 0, job.range.ucount());
+		}
+
+		if (total < parallel_construct_threshold) {
+			for (construct_job<U> const& job : jobs) {
+				if (is_parallel_job(job))
+					construct_components(job, 0, job.range.ucount());
 			}
+			return;
 		}
+
+		struct block {
+			construct_job<U> const* job;
+			std::size_t first;
+			std::size_t last;
+		};
+
+		std::vector<block> blocks;
+		blocks.reserve(jobs.size() + total / parallel_construct_block);
+		for (construct_job<U> const& job : jobs) {
+			if (!is_parallel_job(job))
+				continue;
+			for (std::size_t first = 0; first < job.range.ucount(); first += parallel_construct_block)
+				blocks.push_back({&job, first, std::min(first + parallel_construct_block, job.range.ucount())});
+		}
+
+		std::for_each(std::execution::par, blocks.begin(), blocks.end(), [](block const& b) {
+			construct_components(*b.job, b.first, b.last);
+		});
 	}
 
 	void fill_data_in_existing_chunk(chunk_iter& curr, entity_range r) noexcept {
@@ -649,20 +1905,62 @@ private:
 		}
 	}
 
+	// Moves the components of a chunk to a larger allocation, so components can be appended to it.
+	// The capacity is doubled, or grown to fit the appended range, but never into the range of the next chunk or a reservation.
+	// Returns false if the chunk shares its memory with other chunks, or if there is no room to grow into.
+	template <typename U>
+	bool grow_chunk(chunk_iter c, entity_range const append, std::vector<construct_job<U>>& jobs) requires growable<T> {
+		if (!c->get_owns_data() || c->get_has_split_data())
+			return false;
+
+		std::int64_t const first = c->range.first();
+		std::int64_t last = first + std::max<std::int64_t>(2 * c->range.count(), std::int64_t{append.last()} - first + 1) - 1;
+		last = std::min<std::int64_t>(last, std::numeric_limits<entity_type>::max());
+
+		auto const next = std::next(c);
+		if (next != chunks.end())
+			last = std::min<std::int64_t>(last, std::int64_t{next->range.first()} - 1);
+		for (reservation const& res : reservations) {
+			if (c->range < res.range)
+				last = std::min<std::int64_t>(last, std::int64_t{res.range.first()} - 1);
+		}
+
+		if (last <= c->range.last())
+			return false;
+
+		// Components waiting to be constructed in the chunk must be in place before they are moved
+		run_construct_jobs(jobs);
+		jobs.clear();
+
+		entity_range const new_range{c->range.first(), static_cast<entity_type>(last)};
+		T* const data = allocate_data(alloc, new_range.ucount());
+		auto const offset = static_cast<std::size_t>(c->range.offset(c->active.first()));
+		move_data(c->data.pointer(), c->range.ucount(), offset, data, new_range.ucount(), offset, c->active.ucount());
+		release_data(c->data.pointer(), c->range.ucount());
+
+		c->data = data;
+		c->range = new_range;
+		return true;
+	}
+
 	template <typename U>
 	void process_add_components(std::vector<U>& vec) {
 		if (vec.empty()) {
 			return;
 		}
 
-		// Do the insertions
+		// Do the insertions. The components are constructed after all the chunks are in place
 		auto iter = vec.begin();
 		auto curr = chunks.begin();
+		std::vector<construct_job<U>> jobs;
+
+		// The first entity of the current deferred add. Its range shrinks if it is split over several chunks
+		entity_id entry_first = iter->rng.first();
 
 		// Fill in values
 		while (iter != vec.end()) {
 			if (chunks.empty()) {
-				curr = create_new_chunk<U>(curr, iter);
+				curr = create_new_chunk<U>(curr, iter, entry_first, jobs);
 			} else {
 				entity_range const r = iter->rng;
 
@@ -684,7 +1982,7 @@ private:
 						entity_range const active_range = entity_range::intersect(curr->range, r);
 						fill_data_in_existing_chunk(curr, active_range);
 						if constexpr (!unbound<T>) {
-							construct_range_in_chunk(curr, active_range, iter->data);
+							add_construct_job(jobs, curr, active_range, *iter, entry_first);
 						}
 
 						if (active_range != r) {
@@ -697,20 +1995,83 @@ private:
 						// Incoming range overlaps the current one, so add it into 'curr'
 						fill_data_in_existing_chunk(curr, r);
 						if constexpr (!unbound<T>) {
-							construct_range_in_chunk(curr, r, iter->data);
+							add_construct_job(jobs, curr, r, *iter, entry_first);
 						}
 					}
 				} else if (curr->range < r) {
+					if constexpr (growable<T>) {
+						// Grow the current chunk to hold the incoming range, which is then filled in on the next pass
+						if (curr->active.adjacent(r) && grow_chunk(curr, r, jobs))
+							continue;
+					}
+
 					// Incoming range is larger than the current one, so add it after 'curr'
-					curr = create_new_chunk<U>(std::next(curr), iter);
+					curr = create_new_chunk<U>(std::next(curr), iter, entry_first, jobs);
 					// std::advance(curr, 1);
 				} else if (r < curr->range) {
 					// Incoming range is less than the current one, so add it before 'curr' (after 'prev')
-					curr = create_new_chunk<U>(curr, iter);
+					curr = create_new_chunk<U>(curr, iter, entry_first, jobs);
 				}
 			}
 
 			std::advance(iter, 1);
+			if (iter != vec.end())
+				entry_first = iter->rng.first();
+		}
+
+		if constexpr (!unbound<T>)
+			run_construct_jobs(jobs);
+	}
+
+	// Adds runs of shared components. Runs are extended instead when their neighbours have the same value.
+	void process_add_shared_components(std::vector<entity_data>& vec) requires shared<T> {
+		auto const merge_runs = [](chunk& c, entity_range const r) {
+			c.active = entity_range::merge(c.active, r);
+			c.range = c.active;
+		};
+
+		chunk_iter curr = chunks.begin();
+		for (entity_data& entry : vec) {
+			curr = std::lower_bound(curr, chunks.end(), entry.rng, [](chunk const& c, entity_range const r) { return c.active < r; });
+
+			// Delayed pre-condition check: Can not add components more than once to same entity
+			Pre(curr == chunks.end() || !curr->active.overlaps(entry.rng), "entity already has a component of the type");
+
+			bool const joins_next = curr != chunks.end() && curr->active.adjacent(entry.rng) && is_equal(*curr->data.pointer(), entry.data);
+			if (curr != chunks.begin()) {
+				chunk_iter const prev = std::prev(curr);
+				if (prev->active.adjacent(entry.rng) && is_equal(*prev->data.pointer(), entry.data)) {
+					merge_runs(*prev, entry.rng);
+					if (joins_next) {
+						merge_runs(*prev, curr->active);
+						curr = free_chunk(curr);
+					}
+					continue;
+				}
+			}
+
+			if (joins_next) {
+				merge_runs(*curr, entry.rng);
+			} else {
+				T* const data = allocate_chunk_data(1);
+				std::construct_at(data, std::move(entry.data));
+				curr = create_new_chunk(curr, entry.rng, entry.rng, data);
+			}
+		}
+	}
+
+	// Adds the runs of equal values in a range of shared components
+	template <typename F>
+	void add_shared_runs(entity_range const range, F&& get_value) requires shared<T> {
+		auto& adds = deferred_adds.local();
+		std::size_t const first_run = adds.size();
+
+		for (entity_id const ent : range) {
+			decltype(auto) value = get_value(ent);
+			if (adds.size() > first_run && is_equal(adds.back().data, value))
+				adds.back().rng = entity_range{adds.back().rng.first(), ent};
+			else
+				adds.emplace_back(entity_range{ent, ent}, std::forward<decltype(value)>(value));
 		}
 	}
 
@@ -730,10 +2091,17 @@ private:
 			auto const comparator = [](entity_empty const& l, entity_empty const& r) {
 				return l.rng < r.rng;
 			};
-			std::sort(vec.begin(), vec.end(), comparator);
+			// Batches from command buffers are already sorted
+			if (!std::is_sorted(vec.begin(), vec.end(), comparator)) {
+				if (vec.size() >= parallel_sort_threshold)
+					std::sort(std::execution::par, vec.begin(), vec.end(), comparator);
+				else
+					std::sort(vec.begin(), vec.end(), comparator);
+			}
 
 			// Merge adjacent ranges that has the same data
-			if constexpr (std::is_same_v<entity_data*, decltype(vec.data())>) {
+			// Move-only components can not be shared between entities, so they are never merged
+			if constexpr (std::is_same_v<entity_data*, decltype(vec.data())> && std::copy_constructible<T>) {
 				if constexpr (unbound<T>)
 					combine_erase(vec, combiner_unbound);
 				else
@@ -743,7 +2111,22 @@ private:
 			PreAudit(ensure_no_intersection_ranges(vec_variants, vec),
 				"Two variants have been added at the same time");
 
-			this->process_add_components(vec);
+			// The new components are flagged as modified. The ranges are collected up front,
+			// because adding them shrinks the ranges of entries that are split over several chunks.
+			std::vector<entity_range> added;
+			added.reserve(vec.size());
+			for (auto const& entry : vec)
+				merge_or_add(added, entry.rng);
+
+			if constexpr (shared<T>) {
+				// Shared components are only added as single values
+				if constexpr (std::is_same_v<C, entity_data>)
+					this->process_add_shared_components(vec);
+			} else {
+				this->process_add_components(vec);
+			}
+
+			notify_components_modified(added);
 			vec.clear();
 
 			// Update the state
@@ -751,13 +2134,20 @@ private:
 		};
 
 		deferred_adds.for_each(adder);
-		deferred_adds.clear();
+		clear_deferred(deferred_adds);
 
-		deferred_spans.for_each(adder);
+		if constexpr (std::copy_constructible<T>)
+			deferred_spans.for_each(adder);
 		deferred_spans.clear();
 
+		deferred_vectors.for_each(adder);
+		clear_deferred(deferred_vectors);
+
+		deferred_buffers.for_each(adder);
+		clear_deferred(deferred_buffers);
+
 		deferred_gen.for_each(adder);
-		deferred_gen.clear();
+		clear_deferred(deferred_gen);
 	}
 
 	// Removes the entities and components
@@ -766,11 +2156,13 @@ private:
 			if (vec.empty())
 				return;
 
-			// Sort the ranges to remove
-			std::sort(vec.begin(), vec.end());
+			// Sort the ranges to remove, unless they are a sorted batch from a command buffer
+			if (!std::is_sorted(vec.begin(), vec.end()))
+				std::sort(vec.begin(), vec.end());
 
 			// Remove the ranges
 			this->process_remove_components(vec);
+			set_range_versions(vec, 0);
 
 			// Update the state
 			set_data_removed();
@@ -778,6 +2170,20 @@ private:
 		deferred_removes.clear();
 	}
 
+	// Removes the components of destroyed entities
+	void process_destroyed_entities() noexcept requires(!transient<T>) {
+		// Most pools hold none of the destroyed entities
+		std::erase_if(destroyed_ranges, [this](entity_range const r) { return !has_any_entity(r); });
+		if (destroyed_ranges.empty())
+			return;
+
+		std::sort(destroyed_ranges.begin(), destroyed_ranges.end());
+		process_remove_components(destroyed_ranges);
+		set_range_versions(destroyed_ranges, 0);
+		set_data_removed();
+		destroyed_ranges.clear();
+	}
+
 	void process_remove_components(std::vector<entity_range>& removes) noexcept {
 		chunk_iter it_chunk = chunks.begin();
 		auto it_rem = removes.begin();
@@ -793,16 +2199,30 @@ private:
 					// Delete the chunk and potentially its data
 					it_chunk = free_chunk(it_chunk);
 				} else {
-					// remove partial range
+					// remove partial range. The range to remove can extend past the chunk
+					[[maybe_unused]] entity_range const removed = entity_range::intersect(it_chunk->active, *it_rem);
 					auto const [left_range, maybe_split_range] = entity_range::remove(it_chunk->active, *it_rem);
 
 					// Update the active range
 					it_chunk->active = left_range;
 
+					if constexpr (shared<T>) {
+						// The run keeps its value. The part after a split gets its own copy of it
+						it_chunk->range = left_range;
+						if (maybe_split_range.has_value()) {
+							T* const data = allocate_chunk_data(1);
+							std::construct_at(data, *it_chunk->data.pointer());
+							it_chunk = create_new_chunk(std::next(it_chunk), *maybe_split_range, *maybe_split_range, data);
+						} else {
+							std::advance(it_chunk, 1);
+						}
+						continue;
+					}
+
 					// Destroy the removed components
-					if constexpr (!unbound<T>) {
-						auto const offset = it_chunk->range.offset(it_rem->first());
-						std::destroy_n(&it_chunk->data[offset], it_rem->ucount());
+					if constexpr (!unbound<T> && !soa<T>) {
+						auto const offset = it_chunk->range.offset(removed.first());
+						std::destroy_n(&it_chunk->data[offset], removed.ucount());
 					}
 
 					if (maybe_split_range.has_value()) {
@@ -821,6 +2241,8 @@ private:
 	void process_remove_components() noexcept requires transient<T> {
 		// All transient components are removed each cycle
 		free_all_chunks();
+		changed_ranges.clear();
+		reset_arena();
 	}
 };
 } // namespace ecs::detail
@@ -1,6 +1,9 @@
 #ifndef ECS_DETAIL_COMPONENT_POOL_BASE_H
 #define ECS_DETAIL_COMPONENT_POOL_BASE_H
 
+#include "../memory_report.h"
+#include "snapshot.h"
+
 namespace ecs::detail {
 // The baseclass of typed component pools
 class component_pool_base {
@@ -16,6 +19,19 @@ public:
 	virtual void clear_flags() = 0;
 	virtual void clear() = 0;
 
+	// Returns the memory used by the pool.
+	// Must not be called while components are being added or removed.
+	virtual component_memory_report get_memory_report() = 0;
+
+	// Snapshots of the components in the pool
+	virtual bool is_snapshot_supported() const noexcept = 0;
+	virtual void save_snapshot(snapshot_writer& out) const = 0;
+	virtual bool load_snapshot(snapshot_reader& in) = 0;
+
+	// Removes the components of a range of entities, if the pool has any of them.
+	// Will not be removed until 'process_changes' is called.
+	virtual void remove_entities(class entity_range const& range) = 0;
+
 	// facilitate variant implementation.
 	// Called from other component pools.
 	virtual void remove_variant(class entity_range const& range) = 0;
@@ -58,8 +58,14 @@ template <typename Component, impl::TypeList PoolsList>
 	} else if constexpr (global<T>) {
 		// Global: return the shared component
 		return &pools.template get<T>().get_shared_component();
+	} else if constexpr (is_soa_ref<T>::value) {
+		// Soa: return a reference to the members
+		return pools.template get<naked_component_t<T>>().find_component_ref(entity);
 	} else if constexpr (std::is_same_v<reduce_parent_t<T>, parent_id>) {
 		return pools.template get<parent_id>().find_component_data(entity);
+	} else if constexpr (double_buffered<T> && std::is_reference_v<Component> && !is_read_only_v<Component>) {
+		// Double-buffered: writers get the components for the next cycle
+		return pools.template get<T>().find_next_component_data(entity);
 	} else {
 		// Standard: return the component from the pool
 		return pools.template get<T>().find_component_data(entity);
@@ -76,6 +82,12 @@ decltype(auto) extract_arg_lambda(auto& cmp, [[maybe_unused]] ptrdiff_t offset,
 	} else if constexpr (detail::unbound<T>) {
 		T* ptr = cmp;
 		return *ptr;
+	} else if constexpr (detail::is_soa_ref<T>::value) {
+		return soa_access::advance(cmp, offset);
+	} else if constexpr (detail::shared<T>) {
+		// Arguments never span more than one run, so all the entities share the same component
+		T* ptr = cmp;
+		return *ptr;
 	} else if constexpr (detail::is_parent<T>::value) {
 		parent_id const pid = *(cmp + offset);
 
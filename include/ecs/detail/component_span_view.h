@@ -0,0 +1,102 @@
+#ifndef ECS_DETAIL_COMPONENT_SPAN_VIEW_H
+#define ECS_DETAIL_COMPONENT_SPAN_VIEW_H
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+
+#include "../entity_range.h"
+
+namespace ecs::detail {
+
+// A view of the components of a range of entities, with one span for each run of components
+// that are contiguous in memory. Chunks that are split but still share their memory are joined
+// into a single span. Nothing is copied; the spans point directly into the chunks.
+// 'Chunk' must have the members 'range' and 'active', and 'get_data' returns the components of a chunk.
+template <typename T, typename Chunk>
+class component_span_view {
+public:
+	using get_data_fn = T* (*)(Chunk const&) noexcept;
+
+	class iterator {
+		Chunk const* curr = nullptr;
+		Chunk const* run_last = nullptr;
+		Chunk const* last = nullptr;
+		entity_range range = entity_range::all();
+		get_data_fn get_data = nullptr;
+
+		// Finds the last chunk that shares memory with the current chunk and has adjacent entities
+		void find_run_last() noexcept {
+			run_last = curr;
+			if (curr == last)
+				return;
+
+			T* const data = get_data(*curr);
+			while (run_last + 1 != last && get_data(run_last[1]) == data && run_last->active.adjacent(run_last[1].active))
+				run_last += 1;
+		}
+
+	public:
+		using value_type = std::span<T>;
+		using difference_type = std::ptrdiff_t;
+		using iterator_concept = std::forward_iterator_tag;
+
+		iterator() noexcept = default;
+		iterator(Chunk const* curr_, Chunk const* last_, entity_range range_, get_data_fn get_data_) noexcept
+			: curr{curr_}, last{last_}, range{range_}, get_data{get_data_} {
+			find_run_last();
+		}
+
+		std::span<T> operator*() const noexcept {
+			entity_range const run = entity_range::intersect(range, {curr->active.first(), run_last->active.last()});
+			return {get_data(*curr) + curr->range.offset(run.first()), run.ucount()};
+		}
+
+		iterator& operator++() noexcept {
+			curr = run_last + 1;
+			find_run_last();
+			return *this;
+		}
+
+		iterator operator++(int) noexcept {
+			iterator const tmp = *this;
+			++(*this);
+			return tmp;
+		}
+
+		bool operator==(iterator const& other) const noexcept {
+			return curr == other.curr;
+		}
+	};
+
+	component_span_view() noexcept = default;
+	component_span_view(Chunk const* first_, Chunk const* last_, entity_range range_, get_data_fn get_data_) noexcept
+		: first{first_}, last{last_}, range{range_}, get_data{get_data_} {}
+
+	iterator begin() const noexcept {
+		return {first, last, range, get_data};
+	}
+
+	iterator end() const noexcept {
+		return {last, last, range, get_data};
+	}
+
+	bool empty() const noexcept {
+		return first == last;
+	}
+
+	// Returns the number of components in the view
+	std::size_t num_components() const noexcept {
+		return empty() ? 0 : range.ucount();
+	}
+
+private:
+	Chunk const* first = nullptr;
+	Chunk const* last = nullptr;
+	entity_range range = entity_range::all();
+	get_data_fn get_data = nullptr;
+};
+
+} // namespace ecs::detail
+
+#endif // !ECS_DETAIL_COMPONENT_SPAN_VIEW_H
@@ -1,18 +1,21 @@
 #ifndef ECS_DETAIL_CONTEXT_H
 #define ECS_DETAIL_CONTEXT_H
 
+#include <array>
+#include <atomic>
 #include <map>
 #include <memory>
-//#include <mutex>
+#include <mutex>
 #include <shared_mutex>
 #include <vector>
 #include <execution>
+#include <filesystem>
 
-#include "tls/cache.h"
-#include "tls/split.h"
-
+#include "command_list.h"
 #include "component_pools.h"
+#include "entity_allocator.h"
 #include "scheduler.h"
+#include "snapshot.h"
 #include "system.h"
 #include "system_global.h"
 #include "system_hierachy.h"
@@ -37,12 +40,27 @@ class context final {
 	bool commit_in_progress = false;
 	bool run_in_progress = false;
 
-	using cache_type = tls::cache<type_hash, component_pool_base*, get_type_hash<void>()>;
-	tls::split<cache_type> type_caches;
+	// The component pools indexed by the dense index of their type, so they can be looked up without locking.
+	// The table is split into pages, which are allocated when the first pool in them is created.
+	// Types whose index is beyond the table are looked up through 'pool_type_hash' instead.
+	static constexpr std::size_t pool_page_size = 64;
+	static constexpr std::size_t max_pool_pages = 1024;
+	using pool_page = std::array<std::atomic<component_pool_base*>, pool_page_size>;
+	std::array<std::atomic<pool_page*>, max_pool_pages> pool_pages{};
+
+	// Hands out the ids of entities created by the runtime
+	entity_allocator entities;
+	std::mutex entity_mutex;
+
+	// Commands submitted from command buffers, waiting for the next commit
+	std::vector<std::unique_ptr<command_list_base>> submitted_commands;
+	std::mutex command_mutex;
 
 public:
 	~context() {
 		reset();
+		for (std::atomic<pool_page*>& page : pool_pages)
+			delete page.load(std::memory_order_relaxed);
 	}
 
 	// Commits the changes to the entities.
@@ -50,6 +68,9 @@ public:
 		Pre(!commit_in_progress, "a commit is already in progress");
 		Pre(!run_in_progress, "can not commit changes while systems are running");
 
+		// Queue the commands from command buffers in their component pools
+		queue_submitted_commands();
+
 		// Prevent other threads from
 		//  adding components
 		//  registering new component types
@@ -75,9 +96,76 @@ public:
 			pool->clear_flags();
 		}
 
+		// The components of destroyed entities are gone, so their ids can be reused
+		{
+			std::scoped_lock entity_lock(entity_mutex);
+			entities.recycle();
+		}
+
 		commit_in_progress = false;
 	}
 
+	// Returns a range of new entities
+	entity_range create_entities(std::ptrdiff_t const count) {
+		std::scoped_lock lock(entity_mutex);
+		return entities.create(count);
+	}
+
+	// Queues the removal of all the components of a range of entities. Their ids are recycled on the next commit
+	void destroy_entities(entity_range const range) {
+		Pre(!commit_in_progress, "can not destroy entities while changes are being committed");
+
+		{
+			std::scoped_lock lock(entity_mutex);
+			entities.destroy(range);
+		}
+
+		std::unique_lock component_pool_lock(component_pool_mutex);
+		for (auto const& pool : component_pools)
+			pool->remove_entities(range);
+	}
+
+	// Returns the number of entities created and not yet destroyed
+	std::ptrdiff_t get_created_entity_count() {
+		std::scoped_lock lock(entity_mutex);
+		return entities.num_entities();
+	}
+
+	// Takes the commands recorded in a command buffer. They are queued in their pools in the next commit.
+	void submit_commands(std::vector<std::unique_ptr<command_list_base>>&& lists) {
+		std::scoped_lock lock(command_mutex);
+		if (submitted_commands.empty())
+			submitted_commands = std::move(lists);
+		else
+			std::ranges::move(lists, std::back_inserter(submitted_commands));
+	}
+
+	// Rebuilds the systems that use a component.
+	// Must be called if components are moved outside of 'commit_changes'.
+	template <typename T>
+	void rebuild_systems() {
+		Pre(!commit_in_progress, "can not rebuild systems while changes are being committed");
+		Pre(!run_in_progress, "can not rebuild systems while systems are running");
+
+		std::shared_lock system_lock(system_mutex);
+
+		static constexpr auto hash = get_type_hash<T>();
+		for (auto const& sys : systems) {
+			if (sys->has_component(hash))
+				sys->process_changes(true);
+		}
+	}
+
+	// Allocates memory for a type of component for a range of entities.
+	// Systems can run in parallel, so reservations are not allowed while they run.
+	template <typename T>
+	void reserve(entity_range const range) {
+		Pre(!commit_in_progress, "can not reserve memory while changes are being committed");
+		Pre(!run_in_progress, "can not reserve memory while systems are running");
+
+		get_component_pool<T>().reserve(range);
+	}
+
 	// Calls the 'update' function on all the systems in the order they were added.
 	void run_systems() {
 		Pre(!commit_in_progress, "can not run systems while changes are being committed");
@@ -103,6 +191,72 @@ public:
 		return std::ranges::find(pool_type_hash, hash) != pool_type_hash.end();
 	}
 
+	// Returns the memory used by each component pool
+	std::vector<component_memory_report> get_memory_report() {
+		Pre(!commit_in_progress, "can not report memory usage while changes are being committed");
+
+		std::unique_lock component_pool_lock(component_pool_mutex);
+
+		std::vector<component_memory_report> reports;
+		reports.reserve(component_pools.size());
+		for (auto const& pool : component_pools)
+			reports.push_back(pool->get_memory_report());
+		return reports;
+	}
+
+	// Writes the components of all the types that can be stored in snapshots to a file.
+	// Returns false if the file could not be written.
+	bool save_snapshot(std::filesystem::path const& path) {
+		Pre(!commit_in_progress, "can not save a snapshot while changes are being committed");
+
+		std::unique_lock component_pool_lock(component_pool_mutex);
+
+		auto const num_pools = std::ranges::count_if(component_pools, [](auto const& pool) { return pool->is_snapshot_supported(); });
+
+		snapshot_writer out(path);
+		out.write_header(static_cast<std::uint32_t>(num_pools));
+		{
+			std::scoped_lock entity_lock(entity_mutex);
+			entities.save_snapshot(out);
+		}
+		for (std::size_t i = 0; i < component_pools.size(); ++i) {
+			if (component_pools[i]->is_snapshot_supported()) {
+				out.write(pool_type_hash[i]);
+				component_pools[i]->save_snapshot(out);
+			}
+		}
+
+		return out.good();
+	}
+
+	// Replaces the components in all the pools with the ones in a snapshot.
+	// Returns false if the snapshot could not be read, or holds types without a pool,
+	// in which case the pools are left empty.
+	bool load_snapshot(std::filesystem::path const& path) {
+		Pre(!commit_in_progress, "can not load a snapshot while changes are being committed");
+		Pre(!run_in_progress, "can not load a snapshot while systems are running");
+
+		bool loaded = false;
+		{
+			std::unique_lock component_pool_lock(component_pool_mutex);
+
+			for (auto const& pool : component_pools)
+				pool->clear();
+
+			std::scoped_lock entity_lock(entity_mutex);
+			loaded = load_snapshot_pools(path);
+			if (!loaded) {
+				for (auto const& pool : component_pools)
+					pool->clear();
+				entities.clear();
+			}
+		}
+
+		// Let the systems pick up the new components
+		commit_changes();
+		return loaded;
+	}
+
 	// Resets the runtime state. Removes all systems, empties component pools
 	void reset() {
 		Pre(!commit_in_progress, "a commit is already in progress");
@@ -116,7 +270,16 @@ public:
 		sched.clear();
 		pool_type_hash.clear();
 		component_pools.clear();
-		type_caches.clear();
+		for (std::atomic<pool_page*>& page : pool_pages) {
+			if (pool_page* const p = page.load(std::memory_order_relaxed))
+				std::ranges::for_each(*p, [](std::atomic<component_pool_base*>& pool) { pool.store(nullptr, std::memory_order_relaxed); });
+		}
+
+		std::scoped_lock command_lock(command_mutex);
+		submitted_commands.clear();
+
+		std::scoped_lock entity_lock(entity_mutex);
+		entities.clear();
 	}
 
 	// Returns a reference to a components pool.
@@ -132,26 +295,57 @@ public:
 		// Don't call this when a commit is in progress
 		Pre(!commit_in_progress, "can not get a component pool while a commit is in progress");
 
-		auto& cache = type_caches.local();
+		std::size_t const index = get_type_index<T>();
+		if (component_pool_base* const pool = find_indexed_pool(index))
+			return *static_cast<component_pool<T>*>(pool);
 
-		static constexpr auto hash = get_type_hash<T>();
-		auto pool = cache.get_or(hash, [this](type_hash _hash) {
-			// A new pool might be created, so take a unique lock
-			std::unique_lock component_pool_lock(component_pool_mutex);
+		// A new pool might be created, so take a unique lock
+		std::unique_lock component_pool_lock(component_pool_mutex);
 
-			// Look in the pool for the type
-			auto const it = std::ranges::find(pool_type_hash, _hash);
-			if (it == pool_type_hash.end()) {
-				// The pool wasn't found so create it.
-				return create_component_pool<T>();
-			} else {
-				return component_pools[std::distance(pool_type_hash.begin(), it)].get();
-			}
-		});
+		// Look in the pool for the type, in case another thread created it
+		static constexpr auto hash = get_type_hash<T>();
+		component_pool_base* pool = nullptr;
+		auto const it = std::ranges::find(pool_type_hash, hash);
+		if (it == pool_type_hash.end()) {
+			// The pool wasn't found so create it.
+			pool = create_component_pool<T>();
+		} else {
+			pool = component_pools[static_cast<std::size_t>(std::distance(pool_type_hash.begin(), it))].get();
+		}
 
+		add_indexed_pool(index, pool);
 		return *static_cast<component_pool<T>*>(pool);
 	}
 
+	// Returns the pool of a type from its dense index, or nullptr if it has not been indexed
+	component_pool_base* find_indexed_pool(std::size_t const index) const noexcept {
+		std::size_t const page = index / pool_page_size;
+		if (page >= max_pool_pages)
+			return nullptr;
+
+		pool_page const* const p = pool_pages[page].load(std::memory_order_acquire);
+		if (nullptr == p)
+			return nullptr;
+
+		return (*p)[index % pool_page_size].load(std::memory_order_acquire);
+	}
+
+	// Adds the pool of a type to the index
+	// Pre: the component pool mutex is locked
+	void add_indexed_pool(std::size_t const index, component_pool_base* pool) {
+		std::size_t const page = index / pool_page_size;
+		if (page >= max_pool_pages)
+			return;
+
+		pool_page* p = pool_pages[page].load(std::memory_order_acquire);
+		if (nullptr == p) {
+			p = new pool_page{};
+			pool_pages[page].store(p, std::memory_order_release);
+		}
+
+		(*p)[index % pool_page_size].store(pool, std::memory_order_release);
+	}
+
 	// Regular function
 	template <typename Options, typename UpdateFn, typename SortFn, typename R, typename FirstArg, typename... Args>
 	decltype(auto) create_system(UpdateFn update_func, SortFn sort_func, R(FirstArg, Args...)) {
@@ -198,12 +392,14 @@ private:
 		// Do some checks on the systems
 		static bool constexpr has_sort_func = !std::is_same_v<SortFn, std::nullptr_t>;
 		static bool constexpr has_parent = !std::is_same_v<void, parent_type>;
+		static bool constexpr has_changed_filter = count_type_if<Options, is_changed>() > 0;
 		static bool constexpr is_global_sys = for_all_types<component_list>([]<typename... Types>() {
 				return (detail::global<Types> && ...);
 			});
 
 		static_assert(!(is_global_sys == has_sort_func && is_global_sys), "Global systems can not be sorted");
 		static_assert(!(has_sort_func == has_parent && has_parent == true), "Systems can not both be hierarchial and sorted");
+		static_assert(!(has_changed_filter && (has_parent || is_global_sys)), "Hierarchial and global systems can not use opts::changed");
 
 		// Helper-lambda to insert system
 		auto const insert_system = [this](auto& system) -> decltype(auto) {
@@ -256,6 +452,48 @@ private:
 		}
 	}
 
+	// Queues the submitted commands in their component pools. The commands of each type
+	// are merged, so they are sorted and handed to their pool once.
+	void queue_submitted_commands() {
+		std::vector<std::unique_ptr<command_list_base>> lists;
+		{
+			std::scoped_lock lock(command_mutex);
+			lists.swap(submitted_commands);
+		}
+
+		std::ranges::stable_sort(lists, std::less{}, [](auto const& list) { return list->get_type_hash(); });
+		for (auto first = lists.begin(); first != lists.end();) {
+			auto last = std::next(first);
+			for (; last != lists.end() && (*last)->get_type_hash() == (*first)->get_type_hash(); ++last)
+				(*first)->append(**last);
+
+			(*first)->submit(*this);
+			first = last;
+		}
+	}
+
+	// Reads the entity ids and pools in a snapshot
+	bool load_snapshot_pools(std::filesystem::path const& path) {
+		snapshot_reader in(path);
+
+		std::uint32_t num_pools = 0;
+		if (!in.read_header(num_pools) || !entities.load_snapshot(in))
+			return false;
+
+		for (std::uint32_t i = 0; i < num_pools; ++i) {
+			type_hash hash = 0;
+			if (!in.read(hash))
+				return false;
+
+			// Types that have not been used in the runtime have no pool to load them into
+			auto const it = std::ranges::find(pool_type_hash, hash);
+			if (it == pool_type_hash.end() || !component_pools[std::distance(pool_type_hash.begin(), it)]->load_snapshot(in))
+				return false;
+		}
+
+		return true;
+	}
+
 	// Create a component pool for a new type
 	template <typename T>
 	component_pool_base* create_component_pool() {
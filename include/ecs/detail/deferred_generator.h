@@ -0,0 +1,133 @@
+#ifndef ECS_DETAIL_DEFERRED_GENERATOR_H
+#define ECS_DETAIL_DEFERRED_GENERATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "../entity_id.h"
+#include "../flags.h"
+#include "../soa_ref.h"
+
+namespace ecs::detail {
+
+// A type-erased component generator, used to defer calls to 'add_component_generator'.
+// Small generators are stored inline, so no memory is allocated for them.
+// The erased function constructs a whole block of components, so the
+// generator itself is called directly for each entity.
+template <typename T>
+class deferred_generator {
+	// The size of the inline storage
+	static constexpr std::size_t buffer_size = 6 * sizeof(void*);
+
+	template <typename G>
+	static constexpr bool is_inline =
+		sizeof(G) <= buffer_size && alignof(G) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<G>;
+
+	struct operations {
+		// Constructs 'num' components in 'data' holding 'count' components, starting at 'offset' and entity 'first'
+		void (*generate)(void* gen, T* data, std::size_t count, std::size_t offset, entity_id first, std::size_t num);
+
+		// Moves an inline generator to new storage, and destroys the old one.
+		// Null for generators stored on the heap.
+		void (*relocate)(void* from, void* to) noexcept;
+
+		// Destroys the generator
+		void (*destroy)(void* gen) noexcept;
+	};
+
+	template <typename G>
+	static void generate_n(void* gen, T* data, std::size_t const count, std::size_t const offset, entity_id first, std::size_t const num) {
+		G& fn = *static_cast<G*>(gen);
+		if constexpr (soa<T>) {
+			soa_ref<T> const base = soa_access::make<T>(data, count, offset);
+			for (std::size_t i = 0; i < num; ++i, ++first)
+				soa_access::advance(base, static_cast<std::ptrdiff_t>(i)) = fn(first);
+		} else {
+			(void)count;
+			for (std::size_t i = 0; i < num; ++i, ++first)
+				std::construct_at(data + offset + i, fn(first));
+		}
+	}
+
+	template <typename G>
+	static void relocate(void* from, void* to) noexcept {
+		std::construct_at(static_cast<G*>(to), std::move(*static_cast<G*>(from)));
+		std::destroy_at(static_cast<G*>(from));
+	}
+
+	template <typename G>
+	static void destroy(void* gen) noexcept {
+		if constexpr (is_inline<G>)
+			std::destroy_at(static_cast<G*>(gen));
+		else
+			delete static_cast<G*>(gen);
+	}
+
+	template <typename G>
+	static constexpr operations ops_for{&generate_n<G>, is_inline<G> ? &relocate<G> : nullptr, &destroy<G>};
+
+public:
+	template <typename Fn>
+	requires(!std::is_same_v<std::remove_cvref_t<Fn>, deferred_generator>)
+	explicit deferred_generator(Fn&& fn) : ops(&ops_for<std::remove_cvref_t<Fn>>) {
+		using G = std::remove_cvref_t<Fn>;
+		if constexpr (is_inline<G>)
+			gen = ::new (static_cast<void*>(buffer)) G(std::forward<Fn>(fn));
+		else
+			gen = new G(std::forward<Fn>(fn));
+	}
+
+	deferred_generator(deferred_generator const&) = delete;
+	deferred_generator& operator=(deferred_generator const&) = delete;
+
+	deferred_generator(deferred_generator&& other) noexcept {
+		take(other);
+	}
+
+	deferred_generator& operator=(deferred_generator&& other) noexcept {
+		if (this != &other) {
+			reset();
+			take(other);
+		}
+		return *this;
+	}
+
+	~deferred_generator() {
+		reset();
+	}
+
+	// Constructs 'num' components in 'data' holding 'count' components, starting at 'offset' and entity 'first'
+	void generate(T* data, std::size_t const count, std::size_t const offset, entity_id const first, std::size_t const num) const {
+		ops->generate(gen, data, count, offset, first, num);
+	}
+
+private:
+	void take(deferred_generator& other) noexcept {
+		ops = other.ops;
+		if (nullptr != other.gen && nullptr != ops->relocate) {
+			gen = buffer;
+			ops->relocate(other.gen, buffer);
+		} else {
+			gen = other.gen;
+		}
+		other.gen = nullptr;
+	}
+
+	void reset() noexcept {
+		if (nullptr != gen) {
+			ops->destroy(gen);
+			gen = nullptr;
+		}
+	}
+
+	alignas(std::max_align_t) std::byte buffer[buffer_size];
+	operations const* ops = nullptr;
+	void* gen = nullptr;
+};
+
+} // namespace ecs::detail
+
+#endif // !ECS_DETAIL_DEFERRED_GENERATOR_H
@@ -0,0 +1,163 @@
+#ifndef ECS_DETAIL_ENTITY_ALLOCATOR_H
+#define ECS_DETAIL_ENTITY_ALLOCATOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "../entity_id.h"
+#include "../entity_range.h"
+#include "contract.h"
+#include "snapshot.h"
+
+namespace ecs::detail {
+
+// Hands out contiguous ranges of entity ids, and recycles the ids of destroyed entities.
+// New ranges are placed in the smallest gap between live entities that fits them, so the
+// components of entities created together end up next to existing chunks.
+class entity_allocator {
+	// The sorted ranges of destroyed ids below 'next_id'. Adjacent ranges are always merged.
+	std::vector<entity_range> free_ranges;
+
+	// The ids destroyed since the last call to 'recycle'. Their components are not removed until
+	// the next commit, so the ids are not handed out again before then.
+	std::vector<entity_range> destroyed_ranges;
+
+	// The first id that has never been handed out
+	entity_type next_id = 0;
+
+public:
+	// Returns a range of 'count' unused ids
+	// Pre: count > 0
+	entity_range create(std::ptrdiff_t const count) {
+		Pre(count > 0, "can not create less than one entity");
+
+		// Find the smallest gap that fits the range
+		auto best = free_ranges.end();
+		for (auto it = free_ranges.begin(); it != free_ranges.end(); ++it) {
+			if (it->count() >= count && (best == free_ranges.end() || it->count() < best->count())) {
+				best = it;
+				if (best->count() == count)
+					break;
+			}
+		}
+
+		if (best != free_ranges.end()) {
+			// Take the ids from the start of the gap, next to the entities before it
+			entity_range const range{best->first(), static_cast<entity_type>(best->first() + count - 1)};
+			if (best->count() == count)
+				free_ranges.erase(best);
+			else
+				*best = entity_range{range.last() + 1, best->last()};
+			return range;
+		}
+
+		Pre(count - 1 <= std::ptrdiff_t{std::numeric_limits<entity_type>::max()} - next_id, "out of entity ids");
+		entity_range const range{next_id, static_cast<entity_type>(next_id + count - 1)};
+		next_id = range.last() + 1;
+		return range;
+	}
+
+	// Marks the ids in a range as destroyed. They are available to 'create' again after 'recycle' is called.
+	// Pre: the ids were returned by 'create', and have not been destroyed already
+	void destroy(entity_range const range) {
+		Pre(range.first() >= 0 && range.last() < next_id, "the entities were not created by the runtime");
+		auto const it = std::lower_bound(free_ranges.begin(), free_ranges.end(), range);
+		Pre(it == free_ranges.end() || !it->overlaps(range), "the entities have already been destroyed");
+		PreAudit(std::ranges::none_of(destroyed_ranges, [range](entity_range const r) { return r.overlaps(range); }),
+				 "the entities have already been destroyed");
+
+		destroyed_ranges.push_back(range);
+	}
+
+	// Makes the ids of the destroyed entities available to 'create' again
+	void recycle() {
+		for (entity_range const range : destroyed_ranges)
+			free_range(range);
+		destroyed_ranges.clear();
+	}
+
+	// Returns the number of ids in use
+	std::ptrdiff_t num_entities() const noexcept {
+		std::ptrdiff_t count = next_id;
+		for (entity_range const r : free_ranges)
+			count -= r.count();
+		for (entity_range const r : destroyed_ranges)
+			count -= r.count();
+		return count;
+	}
+
+	// Forgets all the handed out ids
+	void clear() noexcept {
+		free_ranges.clear();
+		destroyed_ranges.clear();
+		next_id = 0;
+	}
+
+	// Writes the handed out ids to a snapshot. The components of destroyed ids that are not
+	// recycled yet are still in the pools, so those ids are stored as being in use.
+	void save_snapshot(snapshot_writer& out) const {
+		out.write(next_id);
+		out.write(std::uint64_t{free_ranges.size()});
+		for (entity_range const r : free_ranges) {
+			out.write(static_cast<entity_type>(r.first()));
+			out.write(static_cast<entity_type>(r.last()));
+		}
+	}
+
+	// Reads the handed out ids from a snapshot.
+	// Returns false if the snapshot data is not valid, in which case all ids are forgotten.
+	bool load_snapshot(snapshot_reader& in) {
+		clear();
+
+		entity_type id = 0;
+		std::uint64_t num_ranges = 0;
+		if (!in.read(id) || !in.read(num_ranges) || id < 0)
+			return false;
+
+		for (std::uint64_t i = 0; i < num_ranges; ++i) {
+			entity_type first = 0;
+			entity_type last = 0;
+			if (!in.read(first) || !in.read(last) || first < 0 || first > last || last >= id ||
+				(!free_ranges.empty() && free_ranges.back().last() + 1 >= first)) {
+				clear();
+				return false;
+			}
+			free_ranges.emplace_back(first, last);
+		}
+
+		next_id = id;
+		return true;
+	}
+
+private:
+	// Adds a range of ids to the free ranges
+	void free_range(entity_range const range) {
+		auto it = std::lower_bound(free_ranges.begin(), free_ranges.end(), range);
+
+		// Merge the range with the gaps next to it
+		entity_range merged = range;
+		if (it != free_ranges.end() && merged.adjacent(*it)) {
+			merged = entity_range::merge(merged, *it);
+			it = free_ranges.erase(it);
+		}
+		if (it != free_ranges.begin() && std::prev(it)->adjacent(merged)) {
+			it = std::prev(it);
+			*it = entity_range::merge(*it, merged);
+		} else {
+			it = free_ranges.insert(it, merged);
+		}
+
+		// Ids at the end are handed out from 'next_id' instead
+		if (free_ranges.back().last() + 1 == next_id) {
+			next_id = free_ranges.back().first();
+			free_ranges.pop_back();
+		}
+	}
+};
+
+} // namespace ecs::detail
+
+#endif // !ECS_DETAIL_ENTITY_ALLOCATOR_H
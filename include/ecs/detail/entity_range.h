@@ -74,6 +74,34 @@ inline void merge_or_add(std::vector<entity_range>& v, entity_range r) {
 		v.push_back(r);
 }
 
+// Adds a set of sorted ranges to another set of sorted ranges.
+// Overlapping and adjacent ranges are combined.
+inline void union_ranges(std::vector<entity_range>& v, entity_range_view ranges) {
+	if (ranges.empty())
+		return;
+
+	std::vector<entity_range> result;
+	result.reserve(v.size() + ranges.size());
+
+	auto const add = [&result](entity_range const r) {
+		if (!result.empty() && (result.back().overlaps(r) || result.back().adjacent(r)))
+			result.back() = entity_range::overlapping(result.back(), r);
+		else
+			result.push_back(r);
+	};
+
+	auto it_a = v.begin();
+	auto it_b = ranges.begin();
+	while (it_a != v.end() || it_b != ranges.end()) {
+		if (it_b == ranges.end() || (it_a != v.end() && it_a->first() < it_b->first()))
+			add(*it_a++);
+		else
+			add(*it_b++);
+	}
+
+	v = std::move(result);
+}
+
 // Find the difference between two sets of ranges.
 // Removes ranges in b from a.
 inline std::vector<entity_range> difference_ranges(entity_range_view view_a, entity_range_view view_b) {
@@ -5,6 +5,7 @@
 #include "system_defs.h"
 #include "component_pools.h"
 #include <array>
+#include <span>
 #include <vector>
 #include <algorithm>
 
@@ -28,6 +29,35 @@ auto get_pool_iterators([[maybe_unused]] component_pools<PoolsList> const& pools
 	}
 }
 
+// Given a list of components, return an array containing the tag bitsets of the corresponding component pools
+template <typename ComponentsList, typename PoolsList>
+auto get_pool_bitsets([[maybe_unused]] component_pools<PoolsList> const& pools) {
+	if constexpr (type_list_is_empty<ComponentsList>) {
+		return std::array<tag_bitset const*, 0>{};
+	} else {
+		return for_all_types<ComponentsList>([&]<typename... Components>() {
+			return std::array<tag_bitset const*, sizeof...(Components)>{pools.template get<Components>().get_tag_bitset()...};
+		});
+	}
+}
+
+// Calls 'callback' with the runs of entities in 'range' that are in all of the
+// bitsets in 'with', and in none of the bitsets in 'without'
+template <typename F>
+void for_each_bitset_run(entity_range const range, std::span<tag_bitset const* const> with, std::span<tag_bitset const* const> without,
+						 F& callback) {
+	if (!with.empty()) {
+		with.front()->for_each_run(range, true, [&](entity_range const run) {
+			for_each_bitset_run(run, with.subspan(1), without, callback);
+		});
+	} else if (!without.empty()) {
+		without.front()->for_each_run(range, false, [&](entity_range const run) {
+			for_each_bitset_run(run, with, without.subspan(1), callback);
+		});
+	} else {
+		callback(range);
+	}
+}
 
 // Find the intersection of the sets of entities in the specified pools
 template <typename InputList, typename PoolsList, typename F>
@@ -52,9 +82,35 @@ void find_entity_pool_intersections_cb(component_pools<PoolsList> const& pools,
 	if (any_emtpy_pools)
 		return;
 
+	// Tag pools with bitsets are intersected a word at a time with the ranges found in the other pools,
+	// so their ranges are not walked. The ranges of one pool are always needed to start from.
+	auto const component_bitsets = get_pool_bitsets<LocalComponentList>(pools);
+	std::array<tag_bitset const*, type_list_size<LocalComponentList>> with_bitsets{};
+	std::size_t num_with_bitsets = 0;
+	std::size_t num_ranged = 0;
+	for (std::size_t i = 0; i < iter_components.size(); ++i) {
+		bool const last_chance = (num_ranged == 0 && i + 1 == iter_components.size());
+		if (component_bitsets[i] != nullptr && !last_chance)
+			with_bitsets[num_with_bitsets++] = component_bitsets[i];
+		else
+			iter_components[num_ranged++] = iter_components[i];
+	}
+	auto const ranged_end = iter_components.begin() + static_cast<std::ptrdiff_t>(num_ranged);
+
 	// Get the iterators for the filters
 	auto iter_filters = get_pool_iterators<FilterList>(pools);
 
+	// Filters with bitsets are also applied a word at a time
+	auto const filter_bitsets = get_pool_bitsets<FilterList>(pools);
+	std::array<tag_bitset const*, type_list_size<FilterList>> without_bitsets{};
+	std::size_t num_without_bitsets = 0;
+	for (std::size_t i = 0; i < iter_filters.size(); ++i) {
+		if (filter_bitsets[i] != nullptr) {
+			without_bitsets[num_without_bitsets++] = filter_bitsets[i];
+			iter_filters[i] = {};
+		}
+	}
+
 	// Sort the filters
 	std::sort(iter_filters.begin(), iter_filters.end(), [](auto const& a, auto const& b) {
 		if (a.current() && b.current())
@@ -68,50 +124,8 @@ void find_entity_pool_intersections_cb(component_pools<PoolsList> const& pools,
 		return it.done();
 	};
 
-	while (!std::any_of(iter_components.begin(), iter_components.end(), done)) {
-		// Get the starting range to test other ranges against
-		entity_range curr_range = *iter_components[0].current();
-
-		// Find all intersections
-		if constexpr (type_list_size<LocalComponentList> == 1) {
-			iter_components[0].next();
-		} else {
-			bool intersection_found = false;
-			for (size_t i = 1; i < iter_components.size(); ++i) {
-				auto& it_a = iter_components[i - 1];
-				auto& it_b = iter_components[i];
-
-				if (curr_range.overlaps(*it_b.current())) {
-					curr_range = entity_range::intersect(curr_range, *it_b.current());
-					intersection_found = true;
-				}
-
-				if (it_a.current()->last() < it_b.current()->last()) {
-					// range a is inside range b, move to
-					// the next range in a
-					it_a.next();
-					if (it_a.done())
-						break;
-
-				} else if (it_b.current()->last() < it_a.current()->last()) {
-					// range b is inside range a,
-					// move to the next range in b
-					it_b.next();
-				} else {
-					// ranges are equal, move to next ones
-					it_a.next();
-					if (it_a.done())
-						break;
-
-					it_b.next();
-				}
-			}
-
-			if (!intersection_found)
-				continue;
-		}
-
-		// Filter the range, if needed
+	// Removes the ranges of the filters from a range, and sends what is left to the callback
+	auto const filter_and_send = [&](entity_range curr_range) {
 		if constexpr (type_list_size<FilterList> > 0) {
 			bool completely_filtered = false;
 			for (auto& it : iter_filters) {
@@ -160,6 +174,57 @@ void find_entity_pool_intersections_cb(component_pools<PoolsList> const& pools,
 			// No filters on this range, so send
 			callback(curr_range);
 		}
+	};
+
+	while (!std::any_of(iter_components.begin(), ranged_end, done)) {
+		// Get the starting range to test other ranges against
+		entity_range curr_range = *iter_components[0].current();
+
+		// Find all intersections
+		if (num_ranged == 1) {
+			iter_components[0].next();
+		} else {
+			bool intersection_found = false;
+			for (size_t i = 1; i < num_ranged; ++i) {
+				auto& it_a = iter_components[i - 1];
+				auto& it_b = iter_components[i];
+
+				if (curr_range.overlaps(*it_b.current())) {
+					curr_range = entity_range::intersect(curr_range, *it_b.current());
+					intersection_found = true;
+				}
+
+				if (it_a.current()->last() < it_b.current()->last()) {
+					// range a is inside range b, move to
+					// the next range in a
+					it_a.next();
+					if (it_a.done())
+						break;
+
+				} else if (it_b.current()->last() < it_a.current()->last()) {
+					// range b is inside range a,
+					// move to the next range in b
+					it_b.next();
+				} else {
+					// ranges are equal, move to next ones
+					it_a.next();
+					if (it_a.done())
+						break;
+
+					it_b.next();
+				}
+			}
+
+			if (!intersection_found)
+				continue;
+		}
+
+		if (num_with_bitsets + num_without_bitsets == 0) {
+			filter_and_send(curr_range);
+		} else {
+			for_each_bitset_run(curr_range, std::span{with_bitsets.data(), num_with_bitsets},
+								std::span{without_bitsets.data(), num_without_bitsets}, filter_and_send);
+		}
 	}
 }
 
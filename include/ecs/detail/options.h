@@ -21,6 +21,21 @@ struct is_interval<T> {
 	static constexpr bool value = true;
 };
 
+//
+// Check if type is a change filter
+template <typename T>
+struct is_changed {
+	static constexpr bool value = false;
+};
+template <typename T>
+struct is_changed<opts::changed<T>> {
+	static constexpr bool value = true;
+};
+
+// Get the component type of a change filter
+template <typename T>
+using changed_component_t = typename T::type;
+
 //
 // Check if type is a parent
 template <typename T>
@@ -2,11 +2,15 @@
 #define ECS_DETAIL_PARENT_H
 
 #include "../entity_id.h"
+#include "../flags.h"
 
 namespace ecs::detail {
 
 // The parent type stored internally in component pools
 ECS_EXPORT struct parent_id : entity_id {
+	// Hierarchies look up parents at random, so give them a lookup index
+	using ecs_flags = ecs::flags<ecs::indexed>;
+
 	constexpr parent_id(detail::entity_type _id) noexcept : entity_id(_id) {}
 };
 
@@ -114,7 +114,13 @@ public:
 				// If the other system doesn't touch the same component,
 				// then there can be no dependency
 				if (dep_node.get_system()->has_component(hash)) {
-					if (dep_node.get_system()->writes_to_component(hash) || sys->writes_to_component(hash)) {
+					bool const dep_writes = dep_node.get_system()->writes_to_component(hash);
+					bool const sys_writes = sys->writes_to_component(hash);
+
+					// Readers of double-buffered components see the values from the previous cycle,
+					// so they only conflict with systems that also write to the component
+					bool const conflicts = sys->is_double_buffered(hash) ? (dep_writes && sys_writes) : (dep_writes || sys_writes);
+					if (conflicts) {
 						// The system writes to the component,
 						// so there is a strong dependency here.
 						inserted = true;
@@ -0,0 +1,83 @@
+#ifndef ECS_DETAIL_SNAPSHOT_H
+#define ECS_DETAIL_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+namespace ecs::detail {
+
+// The layout of a snapshot file:
+//   header:   magic, version, number of pools
+//   entities: the next unused entity id, number of free ranges, the first and last entity of each free range
+//   per pool: type hash, component size, number of runs, number of data bytes,
+//             the first and last entity of each run, then the data of all the runs
+// Values are stored in the native byte order, and the type hashes are only stable
+// between builds from the same compiler, so snapshots are not portable between platforms.
+inline constexpr char snapshot_magic[8] = {'e', 'c', 's', 's', 'n', 'a', 'p', '\0'};
+inline constexpr std::uint32_t snapshot_version = 2;
+
+// Writes the binary data of a snapshot to a file
+class snapshot_writer {
+	std::ofstream file;
+
+public:
+	explicit snapshot_writer(std::filesystem::path const& path) : file(path, std::ios::binary | std::ios::trunc) {}
+
+	void write_header(std::uint32_t const num_pools) {
+		write_bytes(snapshot_magic, sizeof(snapshot_magic));
+		write(snapshot_version);
+		write(num_pools);
+	}
+
+	template <typename T>
+	void write(T const& value) {
+		static_assert(std::is_trivially_copyable_v<T>);
+		write_bytes(&value, sizeof(T));
+	}
+
+	void write_bytes(void const* data, std::size_t const size) {
+		file.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+	}
+
+	// Returns true if all the writes succeeded
+	bool good() const {
+		return file.good();
+	}
+};
+
+// Reads the binary data of a snapshot from a file
+class snapshot_reader {
+	std::ifstream file;
+
+public:
+	explicit snapshot_reader(std::filesystem::path const& path) : file(path, std::ios::binary) {}
+
+	// Reads the header and returns the number of pools in the snapshot.
+	// Returns false if the file is not a snapshot of this version.
+	bool read_header(std::uint32_t& num_pools) {
+		char magic[sizeof(snapshot_magic)]{};
+		std::uint32_t version = 0;
+		if (!read_bytes(magic, sizeof(magic)) || !read(version) || !read(num_pools))
+			return false;
+
+		return 0 == std::memcmp(magic, snapshot_magic, sizeof(magic)) && version == snapshot_version;
+	}
+
+	template <typename T>
+	bool read(T& value) {
+		static_assert(std::is_trivially_copyable_v<T>);
+		return read_bytes(&value, sizeof(T));
+	}
+
+	bool read_bytes(void* data, std::size_t const size) {
+		file.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+		return file.good();
+	}
+};
+
+} // namespace ecs::detail
+
+#endif // !ECS_DETAIL_SNAPSHOT_H
@@ -2,6 +2,7 @@
 #define ECS_DETAIL_SYSTEM_H
 
 #include <array>
+#include <cstdint>
 #include <type_traits>
 #include <utility>
 
@@ -36,23 +37,37 @@ public:
 			return;
 		}
 
+		if constexpr (has_changed_filter)
+			find_changed_ranges();
+
 		do_run();
 
 		// Notify pools if data was written to them
 		for_each_type<ComponentsList>([this]<typename T>() {
-			this->notify_pool_modifed<T>();
+			this->notify_pool_modifed<T>(get_run_ranges());
 		});
+
+		// Changes made by this system are not seen by its next run
+		if constexpr (has_changed_filter)
+			update_changed_versions();
 	}
 
+	// Flags the components in the ranges as modified
 	template <typename T>
-	void notify_pool_modifed() {
+	void notify_pool_modifed(entity_range_view const ranges) {
 		if constexpr (detail::is_parent<T>::value && !is_read_only<T>()) { // writeable parent
-			// Recurse into the parent types
-			for_each_type<parent_type_list_t<T>>([this]<typename... ParentTypes>() {
-				(this->notify_pool_modifed<ParentTypes>(), ...);
+			// The parents that were written to are not known, so flag all their components
+			entity_range const all = entity_range::all();
+			for_each_type<parent_type_list_t<T>>([this, all]<typename... ParentTypes>() {
+				(this->notify_pool_modifed<ParentTypes>({&all, 1}), ...);
 			});
+		} else if constexpr (std::is_reference_v<T> && !is_read_only<T>() && double_buffered<std::remove_cvref_t<T>>) {
+			// Systems reading the components run at the same time as this one, so the pool flags the writes on the next commit
+			pools.template get<std::remove_reference_t<T>>().notify_next_components_modified(ranges);
 		} else if constexpr (std::is_reference_v<T> && !is_read_only<T>() && !std::is_pointer_v<T>) {
-			pools.template get<std::remove_reference_t<T>>().notify_components_modified();
+			pools.template get<std::remove_reference_t<T>>().notify_components_modified(ranges);
+		} else if constexpr (is_soa_ref<T>::value && !is_read_only<T>()) {
+			pools.template get<naked_component_t<T>>().notify_components_modified(ranges);
 		}
 	}
 
@@ -85,7 +100,11 @@ public:
 				return false;
 
 			bool const other_writes = other->writes_to_component(hash);
-			if (other_writes) {
+			if constexpr (double_buffered<T>) {
+				// Readers of double-buffered components see the previous cycle, and writes are
+				// not flagged as changes until the next commit, so only systems that both write to it are ordered
+				return other_writes && writes_to_component(hash);
+			} else if (other_writes) {
 				// The other system writes to the component,
 				// so there is a strong dependency here.
 				// Order is preserved.
@@ -109,7 +128,7 @@ public:
 
 	constexpr bool writes_to_component(detail::type_hash hash) const noexcept override {
 		auto const check_writes = [hash]<typename T>() {
-			return get_type_hash<std::remove_cvref_t<T>>() == hash && !is_read_only<T>();
+			return get_type_hash<stripped_component_t<T>>() == hash && !is_read_only<T>();
 		};
 
 		if (any_of_type<ComponentsList>(check_writes))
@@ -122,6 +141,21 @@ public:
 		}
 	}
 
+	constexpr bool is_double_buffered(detail::type_hash hash) const noexcept override {
+		auto const check_double_buffered = [hash]<typename T>() {
+			return get_type_hash<T>() == hash && double_buffered<T>;
+		};
+
+		if (any_of_type<stripped_component_list>(check_double_buffered))
+			return true;
+
+		if constexpr (has_parent_types) {
+			return any_of_type<parent_component_list>(check_double_buffered);
+		} else {
+			return false;
+		}
+	}
+
 protected:
 	// Handle changes when the component pools change
 	void process_changes(bool force_rebuild) override {
@@ -139,12 +173,42 @@ protected:
 		}
 	}
 
+protected:
+	// Returns the sorted ranges of entities this system runs on
+	entity_range_view get_run_ranges() const noexcept {
+		if constexpr (has_changed_filter)
+			return changed_ranges;
+		else
+			return entity_ranges;
+	}
+
+	// Finds the entities whose components in 'changed_list' have changed since the last run
+	void find_changed_ranges() {
+		std::vector<entity_range> changed;
+		std::size_t index = 0;
+		for_each_type<changed_list>([&]<typename T>() {
+			union_ranges(changed, pools.template get<T>().get_changed_ranges(changed_versions[index++]));
+		});
+
+		using iter = std::vector<entity_range>::const_iterator;
+		changed_ranges = intersect_ranges_iter(iter_pair<iter>{entity_ranges.begin(), entity_ranges.end()},
+											   iter_pair<iter>{changed.begin(), changed.end()});
+	}
+
+	// Remembers the versions of the components in 'changed_list'
+	void update_changed_versions() {
+		std::size_t index = 0;
+		for_each_type<changed_list>([&]<typename T>() {
+			changed_versions[index++] = pools.template get<T>().get_change_version();
+		});
+	}
+
 protected:
 	// Number of components
 	static constexpr size_t num_components = type_list_size<ComponentsList>;
 
 	// List of components used, with all modifiers stripped
-	using stripped_component_list = transform_type<ComponentsList, std::remove_cvref_t>;
+	using stripped_component_list = transform_type<ComponentsList, stripped_component_t>;
 
 	using user_interval = test_option_type_or<is_interval, Options, opts::interval<0, 0>>;
 	using interval_type = interval_limiter<user_interval::ms, user_interval::us>;
@@ -158,6 +222,11 @@ protected:
 	using parent_component_list = parent_type_list_t<stripped_parent_type>;
 	static constexpr bool has_parent_types = !std::is_same_v<full_parent_type, void>;
 
+	// The components passed in 'opts::changed'
+	using changed_list = transform_type<filter_types_if<Options, is_changed>, changed_component_t>;
+	static constexpr bool has_changed_filter = !type_list_is_empty<changed_list>;
+	static_assert(contains_list<stripped_component_list, changed_list>(), "opts::changed<T> can only be used on components that are passed to the system");
+
 
 	// Number of filters
 	static constexpr size_t num_filters = count_type_if<ComponentsList, std::is_pointer>();
@@ -172,6 +241,17 @@ protected:
 	// Fully typed component pools used by this system
 	component_pools<PoolsList> const pools;
 
+	// The sorted ranges of entities this system runs on. Set by 'do_build'.
+	// Components written to by the system are only flagged as modified in these ranges.
+	std::vector<entity_range> entity_ranges;
+
+	// The sorted ranges of entities in 'entity_ranges' whose components in 'changed_list'
+	// have changed since the last run. Set by 'run'.
+	std::vector<entity_range> changed_ranges;
+
+	// The versions of the components in 'changed_list' when the system last ran
+	std::array<std::uint64_t, type_list_size<changed_list>> changed_versions{};
+
 	interval_type interval_checker;
 };
 } // namespace ecs::detail
@@ -54,6 +54,9 @@ public:
 	// Returns true if this system writes data to a specific component
 	[[nodiscard]] virtual bool writes_to_component(detail::type_hash hash) const noexcept = 0;
 
+	// Returns true if a component used by this system is double-buffered, so reading it does not conflict with writing to it
+	[[nodiscard]] virtual bool is_double_buffered(detail::type_hash hash) const noexcept = 0;
+
 private:
 	// Only allow the context class to call 'process_changes'
 	friend class detail::context;
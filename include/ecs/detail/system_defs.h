@@ -17,10 +17,28 @@ using reduce_parent_t =
 		std::conditional_t<is_parent<std::remove_pointer_t<T>>::value, parent_id*, T>,
 		std::conditional_t<is_parent<T>::value, parent_id, T>>;
 
+// If given an ecs::soa_ref, convert to the referenced type, otherwise do nothing
+template <typename T>
+struct reduce_soa {
+	using type = T;
+};
+template <typename T>
+	requires(is_soa_ref<std::remove_cvref_t<T>>::value)
+struct reduce_soa<T> {
+	using type = typename std::remove_cvref_t<T>::element_type;
+};
+template <typename T>
+using reduce_soa_t = typename reduce_soa<T>::type;
+
 // Given a component type, return the naked type without any modifiers.
-// Also converts ecs::parent into ecs::detail::parent_id.
+// Also converts ecs::parent into ecs::detail::parent_id, and ecs::soa_ref into its type.
+template <typename T>
+using naked_component_t = std::remove_pointer_t<std::remove_cvref_t<reduce_parent_t<reduce_soa_t<T>>>>;
+
+// Given a component type, return the type without cv-qualifiers or references.
+// Also converts ecs::soa_ref into its type.
 template <typename T>
-using naked_component_t = std::remove_pointer_t<std::remove_cvref_t<reduce_parent_t<T>>>;
+using stripped_component_t = std::remove_cvref_t<reduce_soa_t<T>>;
 
 // Alias for stored pools
 template <typename T>
@@ -29,7 +47,7 @@ using pool = component_pool<naked_component_t<T>>* const;
 // Returns true if a type is read-only
 template <typename T>
 constexpr bool is_read_only() {
-	return detail::immutable<T> || detail::tagged<T> || std::is_const_v<std::remove_reference_t<T>>;
+	return detail::immutable<T> || detail::tagged<T> || std::is_const_v<std::remove_reference_t<reduce_soa_t<T>>>;
 }
 
 // Helper to extract the parent types
@@ -65,7 +83,9 @@ using parent_pool_tuple_t = typename parent_pool_detect<T>::type;
 template <typename Component>
 using component_argument = std::conditional_t<is_parent<std::remove_cvref_t<Component>>::value,
 											  std::remove_cvref_t<reduce_parent_t<Component>>*,	// parent components are stored as copies
-											  std::remove_cvref_t<Component>*>; // rest are pointers
+							std::conditional_t<is_soa_ref<std::remove_cvref_t<Component>>::value,
+											  soa_ref<naked_component_t<Component>>,	// soa components are stored as references
+											  std::remove_cvref_t<Component>*>>; // rest are pointers
 } // namespace ecs::detail
 
 #endif // !ECS_DETAIL_SYSTEM_DEFS_H
@@ -23,6 +23,8 @@ private:
 	}
 
 	void do_build() override {
+		// Global components are shared by all entities
+		this->entity_ranges.assign(1, entity_range::all());
 	}
 };
 } // namespace ecs::detail
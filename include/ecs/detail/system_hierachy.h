@@ -93,6 +93,7 @@ private:
 
 		// Remove entities from the result
 		ranges = difference_ranges(ranges, ents_to_remove);
+		this->entity_ranges = ranges;
 
 		// Clear the arguments
 		arguments.clear();
@@ -213,7 +214,7 @@ private:
 
 	// The argument for parameter to pass to system func
 	using base_argument_ptr = decltype(for_all_types<ComponentsList>([]<typename... Types>() {
-		return make_argument<Types...>(entity_range{0, 0}, component_argument<Types>{0}...);
+		return make_argument<Types...>(entity_range{0, 0}, component_argument<Types>{}...);
 	}));
 	using base_argument = std::remove_const_t<base_argument_ptr>;
 
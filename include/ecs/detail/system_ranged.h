@@ -21,9 +21,17 @@ public:
 
 private:
 	void do_run() override {
-		// Call the system for all the components that match the system signature
-		for (auto& argument : lambda_arguments) {
-			argument(this->update_func);
+		if constexpr (base::has_changed_filter) {
+			// Call the system for the components that have changed
+			for_all_types<ComponentsList>([this]<typename... Type>() {
+				for (entity_range const range : this->changed_ranges)
+					make_argument<Type...>(range, get_component<Type>(range.first(), this->pools)...)(this->update_func);
+			});
+		} else {
+			// Call the system for all the components that match the system signature
+			for (auto& argument : lambda_arguments) {
+				argument(this->update_func);
+			}
 		}
 	}
 
@@ -31,9 +39,11 @@ private:
 	void do_build() override {
 		// Clear current arguments
 		lambda_arguments.clear();
+		this->entity_ranges.clear();
 
 		for_all_types<ComponentsList>([&]<typename... Type>() {
 			find_entity_pool_intersections_cb<ComponentsList>(this->pools, [this](entity_range found_range) {
+				this->entity_ranges.push_back(found_range);
 				lambda_arguments.push_back(make_argument<Type...>(found_range, get_component<Type>(found_range.first(), this->pools)...));
 			});
 		});
@@ -23,28 +23,76 @@ public:
 
 private:
 	void do_run() override {
-		// Sort the arguments if the component data has been modified
-		if (needs_sorting || this->pools.template get<sort_types>().has_components_been_modified()) {
-			auto const e_p = execution_policy{}; // cannot pass 'execution_policy{}' directly to for_each in gcc
-			std::sort(e_p, sorted_args.begin(), sorted_args.end(), [this](sort_help const& l, sort_help const& r) {
-				return sort_func(*l.sort_val_ptr, *r.sort_val_ptr);
-			});
-
-			needs_sorting = false;
+		// Sort the arguments if the component data has been modified since the last sort
+		component_pool<sort_types> const& pool = this->pools.template get<sort_types>();
+		if (needs_sorting) {
+			sort_all();
+		} else if (pool.get_change_version() != sort_version) {
+			sort_modified(pool.get_changed_ranges(sort_version));
 		}
+		sort_version = pool.get_change_version();
 
 		for (sort_help const& sh : sorted_args) {
+			if constexpr (base::has_changed_filter) {
+				// Skip the components that have not changed
+				entity_id const ent = this->entity_ranges[sh.arg_index].at(sh.offset);
+				auto const it = std::ranges::lower_bound(this->changed_ranges, ent, std::less{}, &entity_range::last);
+				if (it == this->changed_ranges.end() || !it->contains(ent))
+					continue;
+			}
+
 			lambda_arguments[sh.arg_index](this->update_func, sh.offset);
 		}
 	}
 
+	void sort_all() {
+		auto const e_p = execution_policy{}; // cannot pass 'execution_policy{}' directly to for_each in gcc
+		std::sort(e_p, sorted_args.begin(), sorted_args.end(), sort_compare{sort_func});
+
+		needs_sorting = false;
+	}
+
+	// Re-sorts the arguments whose sort values are in the modified ranges.
+	// The unmodified arguments are still in sorted order, so the modified
+	// ones are sorted on their own and merged back in.
+	void sort_modified(entity_range_view const modified_ranges) {
+		using iter = std::vector<entity_range>::const_iterator;
+		std::vector<entity_range> const modified = intersect_ranges_iter(
+			iter_pair<iter>{this->entity_ranges.begin(), this->entity_ranges.end()},
+			iter_pair<entity_range_view::iterator>{modified_ranges.begin(), modified_ranges.end()});
+		if (modified.empty())
+			return;
+
+		std::size_t num_modified = 0;
+		for (entity_range const& range : modified)
+			num_modified += range.ucount();
+
+		// Fall back to a full sort if a large part of the arguments are modified
+		if (num_modified * partial_sort_ratio >= sorted_args.size()) {
+			sort_all();
+			return;
+		}
+
+		auto const is_unmodified = [this, &modified](sort_help const& sh) {
+			entity_id const ent = this->entity_ranges[sh.arg_index].at(sh.offset);
+			auto const it = std::ranges::lower_bound(modified, ent, std::less{}, &entity_range::last);
+			return it == modified.end() || !it->contains(ent);
+		};
+		auto const mid = std::stable_partition(sorted_args.begin(), sorted_args.end(), is_unmodified);
+
+		std::sort(mid, sorted_args.end(), sort_compare{sort_func});
+		std::inplace_merge(sorted_args.begin(), mid, sorted_args.end(), sort_compare{sort_func});
+	}
+
 	// Convert a set of entities into arguments that can be passed to the system
 	void do_build() override {
 		sorted_args.clear();
 		lambda_arguments.clear();
+		this->entity_ranges.clear();
 
 		for_all_types<ComponentsList>([&]<typename... Types>() {
 			find_entity_pool_intersections_cb<ComponentsList>(this->pools, [this, index = 0u](entity_range range) mutable {
+				this->entity_ranges.push_back(range);
 				lambda_arguments.push_back(make_argument<Types...>(range, get_component<Types>(range.first(), this->pools)...));
 
 				for (entity_id const entity : range) {
@@ -81,11 +129,26 @@ private:
 	// True if the data needs to be sorted
 	bool needs_sorting = false;
 
+	// The version of the sorted components when they were last sorted
+	std::uint64_t sort_version = 0;
+
+	// Modified arguments are only re-sorted on their own if they are less than
+	// 1/partial_sort_ratio of all the arguments
+	static constexpr std::size_t partial_sort_ratio = 4;
+
 	struct sort_help {
 		unsigned arg_index;
 		entity_offset offset;
 		sort_types* sort_val_ptr;
 	};
+
+	struct sort_compare {
+		SortFunc const& sort_func;
+
+		bool operator()(sort_help const& l, sort_help const& r) const {
+			return sort_func(*l.sort_val_ptr, *r.sort_val_ptr);
+		}
+	};
 	std::vector<sort_help> sorted_args;
 
 	using base_argument = decltype(for_all_types<ComponentsList>([]<typename... Types>() {
@@ -0,0 +1,145 @@
+#ifndef ECS_DETAIL_TAG_BITSET_H
+#define ECS_DETAIL_TAG_BITSET_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "../entity_id.h"
+#include "../entity_range.h"
+#include "stride_view.h"
+
+namespace ecs::detail {
+
+// A two-level bitset over the entities of a tag pool. When the tags are scattered over many
+// small ranges, the entities shared with other pools can be found a word at a time instead
+// of by walking every range.
+class tag_bitset {
+	using word = std::uint64_t;
+	static constexpr std::size_t word_bits = 64;
+
+	// The first entity in the bitset
+	std::int64_t base = 0;
+
+	// One bit per entity, starting at 'base'
+	std::vector<word> words;
+
+	// One bit per word, which is set if the word has any bits set
+	std::vector<word> summary;
+
+public:
+	bool empty() const noexcept {
+		return words.empty();
+	}
+
+	void clear() noexcept {
+		words.clear();
+		summary.clear();
+	}
+
+	// Returns the number of bytes allocated by the bitset
+	std::size_t memory_usage() const noexcept {
+		return (words.capacity() + summary.capacity()) * sizeof(word);
+	}
+
+	// Rebuilds the bitset from a set of sorted ranges
+	template <std::size_t Stride>
+	void build(stride_view<Stride, entity_range const> ranges) {
+		clear();
+		if (ranges.done())
+			return;
+
+		base = ranges.current()->first();
+		std::int64_t last = base;
+		for (auto it = ranges; !it.done(); it.next())
+			last = it.current()->last();
+
+		std::size_t const num_bits = static_cast<std::size_t>(last - base + 1);
+		words.assign((num_bits + word_bits - 1) / word_bits, 0);
+		summary.assign((words.size() + word_bits - 1) / word_bits, 0);
+
+		for (; !ranges.done(); ranges.next())
+			set_range(*ranges.current());
+	}
+
+	// Calls 'callback' with each run of entities in 'range' that are in the bitset if 'set' is true,
+	// or that are not in the bitset if 'set' is false
+	template <typename F>
+	void for_each_run(entity_range const range, bool const set, F&& callback) const {
+		std::int64_t pos = std::int64_t{range.first()} - base;
+		std::int64_t const end = std::int64_t{range.last()} - base + 1;
+
+		while (pos < end) {
+			std::int64_t const run_first = find_bit(pos, end, set);
+			if (run_first >= end)
+				break;
+
+			std::int64_t const run_end = find_bit(run_first, end, !set);
+			callback(entity_range{static_cast<entity_type>(run_first + base), static_cast<entity_type>(run_end - 1 + base)});
+			pos = run_end;
+		}
+	}
+
+private:
+	void set_range(entity_range const range) noexcept {
+		auto const first = static_cast<std::size_t>(std::int64_t{range.first()} - base);
+		auto const last = static_cast<std::size_t>(std::int64_t{range.last()} - base);
+		std::size_t const first_word = first / word_bits;
+		std::size_t const last_word = last / word_bits;
+
+		word const first_mask = ~word{0} << (first % word_bits);
+		word const last_mask = ~word{0} >> (word_bits - 1 - last % word_bits);
+		if (first_word == last_word) {
+			words[first_word] |= first_mask & last_mask;
+		} else {
+			words[first_word] |= first_mask;
+			std::fill(words.begin() + static_cast<std::ptrdiff_t>(first_word + 1), words.begin() + static_cast<std::ptrdiff_t>(last_word), ~word{0});
+			words[last_word] |= last_mask;
+		}
+
+		for (std::size_t w = first_word; w <= last_word; ++w)
+			summary[w / word_bits] |= word{1} << (w % word_bits);
+	}
+
+	// Returns the index of the first word at or after 'index' with any bits set, or the number of words
+	std::size_t find_nonempty_word(std::size_t index) const noexcept {
+		while (index < words.size()) {
+			word const s = summary[index / word_bits] >> (index % word_bits);
+			if (s != 0)
+				return index + static_cast<std::size_t>(std::countr_zero(s));
+
+			index = (index / word_bits + 1) * word_bits;
+		}
+		return words.size();
+	}
+
+	// Returns the position of the first bit in [pos, end) that equals 'value', or 'end' if there is none.
+	// Bits outside of the bitset are not set.
+	std::int64_t find_bit(std::int64_t pos, std::int64_t const end, bool const value) const noexcept {
+		auto const num_bits = static_cast<std::int64_t>(words.size() * word_bits);
+		if (pos < 0) {
+			if (!value)
+				return std::min(pos, end);
+			pos = 0;
+		}
+
+		while (pos < end && pos < num_bits) {
+			auto const bit = static_cast<std::size_t>(pos);
+			std::size_t const index = bit / word_bits;
+			word const w = (value ? words[index] : ~words[index]) >> (bit % word_bits);
+			if (w != 0)
+				return std::min(end, pos + std::countr_zero(w));
+
+			// Skip the words without any bits set when looking for a set bit
+			std::size_t const next = value ? find_nonempty_word(index + 1) : index + 1;
+			pos = static_cast<std::int64_t>(next * word_bits);
+		}
+
+		return (value || pos >= end) ? end : pos;
+	}
+};
+
+} // namespace ecs::detail
+
+#endif // !ECS_DETAIL_TAG_BITSET_H
@@ -1,7 +1,10 @@
 #ifndef ECS_DETAIL_TYPE_HASH_H
 #define ECS_DETAIL_TYPE_HASH_H
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <string_view>
 
 // Beware of using this with local defined structs/classes
 // https://developercommunity.visualstudio.com/content/problem/1010773/-funcsig-missing-data-from-locally-defined-structs.html
@@ -28,6 +31,32 @@ consteval type_hash get_type_hash() {
 	return hash;
 }
 
+// Returns the name of a type, as spelled by the compiler
+template <typename T>
+constexpr std::string_view get_type_name() {
+#ifdef _MSC_VER
+	std::string_view const sig = __FUNCSIG__;
+	auto const first = sig.find("get_type_name<") + 14;
+	auto const last = sig.rfind(">(void)");
+#else
+	std::string_view const sig = __PRETTY_FUNCTION__;
+	auto const first = sig.find("T = ") + 4;
+	auto const last = sig.find_first_of(";]", first);
+#endif
+	return sig.substr(first, last - first);
+}
+
+// The number of types that have been given a dense index
+inline std::atomic<std::size_t> type_index_counter{0};
+
+// Returns a dense index for a type. Indices are handed out in the order the types are first used,
+// so they are only stable for the lifetime of the program.
+template <typename T>
+std::size_t get_type_index() noexcept {
+	static std::size_t const index = type_index_counter.fetch_add(1, std::memory_order_relaxed);
+	return index;
+}
+
 template <typename TypesList>
 consteval auto get_type_hashes_array() {
 	return for_all_types<TypesList>([]<typename... Types>() {
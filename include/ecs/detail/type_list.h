@@ -158,12 +158,12 @@ namespace ecs::detail {
 
 		template <template <typename> typename Predicate, typename... Types>
 		constexpr std::size_t count_type_if(type_list<Types...>*) {
-			return static_cast<std::size_t>((Predicate<Types>::value + ...));
+			return static_cast<std::size_t>((0 + ... + Predicate<Types>::value));
 		}
 
 		template <typename... Types, typename F>
 		constexpr std::size_t count_type_if(F&& f, type_list<Types...>*) {
-			return (static_cast<std::size_t>(f.template operator()<Types>()) + ...);
+			return (std::size_t{0} + ... + static_cast<std::size_t>(f.template operator()<Types>()));
 		}
 
 		template <typename TL>
@@ -227,6 +227,11 @@ namespace ecs::detail {
 
 		template <typename TL, template <typename O> typename Predicate>
 		struct filter_types_if {
+			template <typename Result>
+			constexpr static auto helper(type_list<>*) {
+				return static_cast<Result*>(nullptr);
+			}
+
 			template <typename Result, typename Front, typename... Rest>
 			constexpr static auto helper(type_list<Front, Rest...>*) {
 				if constexpr (Predicate<Front>::value) {
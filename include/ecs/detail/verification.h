@@ -106,7 +106,25 @@ constexpr void verify_global_component() {
 template <typename C>
 constexpr void verify_immutable_component() {
 	if constexpr (detail::immutable<C>) {
-		static_assert(std::is_const_v<std::remove_reference_t<C>>, "components flagged as 'immutable' must also be const");
+		static_assert(std::is_const_v<std::remove_reference_t<reduce_soa_t<C>>>, "components flagged as 'immutable' must also be const");
+	}
+}
+
+// Implement the requirements for soa components
+template <typename C>
+constexpr void verify_soa_component() {
+	if constexpr (!std::is_pointer_v<C> && detail::soa<C>) {
+		static_assert(is_soa_ref<std::remove_cvref_t<C>>::value, "components flagged as 'soa' must be passed as ecs::soa_ref<T> or ecs::soa_ref<T const>");
+		static_assert(!std::is_reference_v<C>, "ecs::soa_ref must be passed by value");
+	}
+}
+
+// Implement the requirements for shared components
+template <typename C>
+constexpr void verify_shared_component() {
+	if constexpr (!std::is_pointer_v<C> && detail::shared<C>) {
+		static_assert(!std::is_reference_v<C> || std::is_const_v<std::remove_reference_t<C>>,
+					  "components flagged as 'share' are shared between entities, so systems can not write to them; use 'runtime::set_shared_component'");
 	}
 }
 
@@ -114,7 +132,7 @@ template <typename R, typename FirstArg, typename... Args>
 constexpr void system_verifier() {
 	static_assert(std::is_same_v<R, void>, "systems can not have return values");
 
-	static_assert(is_unique_type_args < std::remove_cvref_t<FirstArg>, std::remove_cvref_t<Args>...>(),
+	static_assert(is_unique_type_args<stripped_component_t<FirstArg>, stripped_component_t<Args>...>(),
 				  "component parameter types can only be specified once");
 
 	if constexpr (is_entity<FirstArg>) {
@@ -127,12 +145,16 @@ constexpr void system_verifier() {
 		verify_global_component<FirstArg>();
 		verify_tagged_component<FirstArg>();
 		verify_parent_component<FirstArg>();
+		verify_soa_component<FirstArg>();
+		verify_shared_component<FirstArg>();
 	}
 
 	(verify_immutable_component<Args>(), ...);
 	(verify_global_component<Args>(), ...);
 	(verify_tagged_component<Args>(), ...);
 	(verify_parent_component<Args>(), ...);
+	(verify_soa_component<Args>(), ...);
+	(verify_shared_component<Args>(), ...);
 }
 
 // A small bridge to allow the Lambda to activate the system verifier
@@ -184,6 +206,7 @@ constexpr bool make_system_parameter_verifier() {
 
 		using sort_types = sorter_predicate_type_t<SortFunc>;
 		static_assert(std::predicate<SortFunc, sort_types, sort_types>, "Sorting function is not a predicate");
+		static_assert(!detail::soa<sort_types>, "components flagged as 'soa' can not be used for sorting");
 	}
 
 	return true;
@@ -1,6 +1,10 @@
 #ifndef ECS_FLAGS_H
 #define ECS_FLAGS_H
 
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+
 namespace ecs {
 ECS_EXPORT enum ComponentFlags {
 	// Add this in a component to mark it as tag.
@@ -24,13 +28,61 @@ ECS_EXPORT enum ComponentFlags {
 	// having been added to any entities.
 	// Uses O(1) memory instead of O(n).
 	// Mutually exclusive with 'tag', 'share', and 'transient'
-	global = 1 << 3
+	global = 1 << 3,
+
+	// Add this in a component to give its pool a paged lookup index.
+	// Looking up a single entity's component is done in O(1) instead
+	// of a binary search, at the cost of a small amount of memory.
+	// Has no effect on 'tag' and 'global' components.
+	indexed = 1 << 4,
+
+	// Add this in a component to store each of its members in a separate array.
+	// Systems access the component through an 'ecs::soa_ref', so they only
+	// touch the members they use. Must be a trivially copyable aggregate.
+	// Mutually exclusive with 'tag' and 'global'
+	soa = 1 << 5,
+
+	// Add this in a component to store one value per run of adjacent entities with equal components,
+	// instead of one per entity. Systems can only read the component; changing it on some of the
+	// entities in a run is done with 'runtime::set_shared_component', which splits the run.
+	// Must be copyable and comparable.
+	// Mutually exclusive with 'tag', 'global', and 'soa'
+	share = 1 << 6,
+
+	// Add this in a component to keep two copies of it, so systems that read it can run
+	// concurrently with systems that write to it. Systems that read the component see the
+	// values from the previous cycle, and systems that write to it produce the values for the
+	// next cycle, which become the current values in 'commit_changes'. Must be trivially copyable.
+	// Mutually exclusive with 'tag', 'global', 'transient', 'share', and 'soa'
+	double_buffer = 1 << 7,
+
+	// Add this in a component to let its chunks grow geometrically when components are added to the
+	// entities right after them, instead of adding a new chunk for each batch of appended entities.
+	// The components in a growing chunk are moved, and the unused capacity is kept until it is defragmented.
+	// Mutually exclusive with 'tag', 'global', 'transient', and 'share'
+	grow = 1 << 8
 };
 
 ECS_EXPORT template <ComponentFlags... Flags>
 struct flags {
 	static constexpr int val = (Flags | ...);
 };
+
+// Add this in a component to control how its chunks are laid out in memory,
+// eg. 'using ecs_layout = ecs::layout<64, 8>;'
+// 'Alignment' is the alignment of the first component in each chunk.
+// 'Padding' rounds the number of components allocated for each chunk up to a multiple of it.
+// The padding is zero-initialized, so full-width vector loads can read past the
+// last component of a chunk. Padding requires trivially copyable components.
+// Has no effect on 'tag' and 'global' components.
+ECS_EXPORT template <std::size_t Alignment, std::size_t Padding = 1>
+struct layout {
+	static_assert(std::has_single_bit(Alignment), "alignment must be a power of two");
+	static_assert(Padding > 0, "padding must be at least one component");
+
+	static constexpr std::size_t alignment = Alignment;
+	static constexpr std::size_t padding = Padding;
+};
 }
 
 // Some helper concepts/struct to detect flags
@@ -53,6 +105,21 @@ concept immutable = ComponentFlags::immutable == (stripped_t<T>::ecs_flags::val
 template <typename T>
 concept global = ComponentFlags::global == (stripped_t<T>::ecs_flags::val & ComponentFlags::global);
 
+template <typename T>
+concept indexed = ComponentFlags::indexed == (stripped_t<T>::ecs_flags::val & ComponentFlags::indexed);
+
+template <typename T>
+concept soa = ComponentFlags::soa == (stripped_t<T>::ecs_flags::val & ComponentFlags::soa);
+
+template <typename T>
+concept shared = ComponentFlags::share == (stripped_t<T>::ecs_flags::val & ComponentFlags::share);
+
+template <typename T>
+concept double_buffered = ComponentFlags::double_buffer == (stripped_t<T>::ecs_flags::val & ComponentFlags::double_buffer);
+
+template <typename T>
+concept growable = ComponentFlags::grow == (stripped_t<T>::ecs_flags::val & ComponentFlags::grow);
+
 template <typename T>
 concept local = !global<T>;
 
@@ -62,6 +129,20 @@ concept persistent = !transient<T>;
 template <typename T>
 concept unbound = (tagged<T> || global<T>); // component is not bound to a specific entity (ie static)
 
+template <typename T>
+concept has_layout = requires { stripped_t<T>::ecs_layout::alignment; stripped_t<T>::ecs_layout::padding; };
+
+// The alignment and padding requested by a component, or the defaults if it has no 'ecs_layout'
+template <typename T>
+struct component_layout : layout<alignof(std::remove_cvref_t<T>), 1> {};
+
+template <has_layout T>
+struct component_layout<T> : stripped_t<T>::ecs_layout {
+	static_assert(stripped_t<T>::ecs_layout::padding == 1 || std::is_trivially_copyable_v<stripped_t<T>>,
+				  "padded components must be trivially copyable");
+	static_assert(stripped_t<T>::ecs_layout::padding == 1 || !soa<T>, "'soa' components can not be padded");
+};
+
 //
 template <typename T>
 struct is_tagged : std::bool_constant<tagged<T>> {};
@@ -75,6 +156,21 @@ struct is_immutable : std::bool_constant<immutable<T>> {};
 template <typename T>
 struct is_global : std::bool_constant<global<T>> {};
 
+template <typename T>
+struct is_indexed : std::bool_constant<indexed<T>> {};
+
+template <typename T>
+struct is_soa : std::bool_constant<soa<T>> {};
+
+template <typename T>
+struct is_shared : std::bool_constant<shared<T>> {};
+
+template <typename T>
+struct is_double_buffered : std::bool_constant<double_buffered<T>> {};
+
+template <typename T>
+struct is_growable : std::bool_constant<growable<T>> {};
+
 template <typename T>
 struct is_local : std::bool_constant<!global<T>> {};
 
@@ -114,5 +210,38 @@ namespace {
 		using ecs_flags = ecs::flags<ecs::global>;
 	};
 	static_assert(ecs::detail::global<test_global>);
+
+	struct test_indexed {
+		using ecs_flags = ecs::flags<ecs::indexed>;
+	};
+	static_assert(ecs::detail::indexed<test_indexed>);
+
+	struct test_soa {
+		using ecs_flags = ecs::flags<ecs::soa>;
+	};
+	static_assert(ecs::detail::soa<test_soa>);
+
+	struct test_shared {
+		using ecs_flags = ecs::flags<ecs::share>;
+	};
+	static_assert(ecs::detail::shared<test_shared>);
+
+	struct test_double_buffered {
+		using ecs_flags = ecs::flags<ecs::double_buffer>;
+	};
+	static_assert(ecs::detail::double_buffered<test_double_buffered>);
+
+	struct test_growable {
+		using ecs_flags = ecs::flags<ecs::grow>;
+	};
+	static_assert(ecs::detail::growable<test_growable>);
+
+	struct test_layout {
+		using ecs_layout = ecs::layout<64, 8>;
+	};
+	static_assert(ecs::detail::has_layout<test_layout>);
+	static_assert(64 == ecs::detail::component_layout<test_layout>::alignment);
+	static_assert(8 == ecs::detail::component_layout<test_layout>::padding);
+	static_assert(1 == ecs::detail::component_layout<test_soa>::padding);
 } // namespace
 #endif // !ECS_FLAGS_H
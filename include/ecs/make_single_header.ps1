@@ -16,10 +16,18 @@ $files = (
 	'detail/entity_iterator.h',
 	'detail/options.h',
 	'entity_range.h',
+	'flags.h',
+	'soa_ref.h',
+	'defragment_result.h',
+	'memory_report.h',
+	'unique_buffer.h',
 	'detail/parent_id.h',
 	'detail/variant.h',
-	'flags.h',
 	'detail/stride_view.h',
+	'detail/tag_bitset.h',
+	'detail/component_span_view.h',
+	'detail/deferred_generator.h',
+	'detail/snapshot.h',
 	'detail/component_pool_base.h',
 	'detail/component_pool.h',
 	'detail/system_defs.h',
@@ -37,23 +45,34 @@ $files = (
 	'detail/system_ranged.h',
 	'detail/system_global.h',
 	'detail/scheduler.h',
+	'detail/command_list.h',
+	'detail/entity_allocator.h',
 	'detail/context.h',
+	'command_buffer.h',
 	'runtime.h')
 
 # Write all system includes
 $sys_headers = '#include <algorithm>
 #include <array>
 #include <atomic>
+#include <bit>
 #include <chrono>
 #include <concepts>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <execution>
+#include <filesystem>
 #include <forward_list>
+#include <fstream>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <limits>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
+#include <new>
 #include <optional>
 #include <ranges>
 #include <shared_mutex>
@@ -61,6 +80,8 @@ $sys_headers = '#include <algorithm>
 #include <stacktrace>
 #endif
 #include <span>
+#include <string_view>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <vector>'
@@ -0,0 +1,48 @@
+#ifndef ECS_MEMORY_REPORT_H
+#define ECS_MEMORY_REPORT_H
+
+#include <cstddef>
+#include <string_view>
+
+namespace ecs {
+// The memory used by the component pool of a single type
+ECS_EXPORT struct component_memory_report {
+	// The name of the component type, as spelled by the compiler
+	std::string_view name;
+
+	// The number of bytes allocated to store components, including unused memory
+	std::size_t bytes_allocated = 0;
+
+	// The number of bytes holding the components of entities. Double-buffered components count both buffers
+	std::size_t bytes_live = 0;
+
+	// The number of bytes used to keep track of the components, like chunks and lookup indices
+	std::size_t bytes_bookkeeping = 0;
+
+	// The number of bytes reserved by the queues of components waiting to be added or removed
+	std::size_t bytes_deferred = 0;
+
+	// The number of entities with the component
+	std::ptrdiff_t num_entities = 0;
+
+	// The number of chunks the entities are stored in
+	std::ptrdiff_t num_chunks = 0;
+
+	// The number of chunks that share their memory with other chunks, because entities were removed
+	std::ptrdiff_t num_split_chunks = 0;
+
+	// The average number of entities in each chunk
+	double average_run_length = 0.0;
+
+	// The share of single-entity lookups that found the entity in the cached chunk.
+	// Lookups are only counted when ECS_ENABLE_LOOKUP_STATS is set to 1, otherwise this is always 0.
+	float lookup_hit_rate = 0.0f;
+
+	// Returns the number of allocated bytes that are not holding components
+	std::size_t bytes_unused() const noexcept {
+		return bytes_allocated - bytes_live;
+	}
+};
+} // namespace ecs
+
+#endif // !ECS_MEMORY_REPORT_H
@@ -15,6 +15,11 @@ ECS_EXPORT namespace ecs::opts {
 	struct manual_update {};
 
 	struct not_parallel {};
+
+	template <typename T>
+	struct changed {
+		using type = T;
+	};
 	// struct not_concurrent {};
 
 } // namespace ecs::opts
@@ -23,6 +23,7 @@ namespace ecs {
 ECS_EXPORT template <typename... ParentTypes>
 struct parent : entity_id, private std::conditional_t<(sizeof...(ParentTypes) > 0), detail::void_ptr_storage<sizeof...(ParentTypes)>, detail::empty_storage> {
 	static_assert((!detail::global<ParentTypes> && ...), "global components are not allowed in parents");
+	static_assert((!detail::soa<ParentTypes> && ...), "soa components are not allowed in parents");
 	static_assert((!detail::is_parent<ParentTypes>::value && ...), "parents in parents is not supported");
 
 	explicit parent(entity_id id) : entity_id(id) {}
@@ -2,8 +2,11 @@
 #define ECS_RUNTIME_H
 
 #include <concepts>
+#include <execution>
+#include <filesystem>
 #include <type_traits>
 
+#include "command_buffer.h"
 #include "detail/component_pool.h"
 #include "detail/context.h"
 #include "detail/contract.h"
@@ -11,9 +14,13 @@
 #include "detail/type_list.h"
 #include "detail/variant.h"
 #include "detail/verification.h"
+#include "defragment_result.h"
+#include "memory_report.h"
 #include "entity_id.h"
 #include "flags.h"
 #include "options.h"
+#include "soa_ref.h"
+#include "unique_buffer.h"
 
 namespace ecs {
 	ECS_EXPORT class runtime {
@@ -35,13 +42,14 @@ namespace ecs {
 					pool.add(range, detail::parent_id{val.id()});
 				} else if constexpr (std::is_reference_v<Type>) {
 					using DerefT = std::remove_cvref_t<Type>;
-					static_assert(std::copyable<DerefT>, "Type must be copyable");
+					static_assert(std::copy_constructible<DerefT>, "Type must be copyable, or be moved into the runtime");
 
 					detail::component_pool<DerefT>& pool = ctx.get_component_pool<DerefT>();
 					Pre(!pool.has_entity(range), "one- or more entities in the range already has this type");
 					pool.add(range, val);
 				} else {
-					static_assert(std::copyable<Type>, "Type must be copyable");
+					static_assert(std::move_constructible<Type>, "Type must be movable");
+					Pre(std::copy_constructible<Type> || range.count() == 1, "move-only components can only be added to one entity at a time");
 
 					detail::component_pool<Type>& pool = ctx.get_component_pool<Type>();
 					Pre(!pool.has_entity(range), "one- or more entities in the range already has this type");
@@ -62,7 +70,7 @@ namespace ecs {
 			static_assert(!std::is_pointer_v<std::remove_cvref_t<T>>, "can not add pointers to entities; wrap them in a struct");
 			// static_assert(!detail::is_parent<std::remove_cvref_t<T>>::value, "adding spans of parents is not (yet?) supported"); //
 			// should work
-			static_assert(std::copyable<T>, "Type must be copyable");
+			static_assert(std::copy_constructible<T>, "Type must be copyable, or the range must be moved into the runtime");
 
 			Pre(range.ucount() == std::size(vals), "range and span must be same size");
 
@@ -80,27 +88,67 @@ namespace ecs {
 			}
 		}
 
-		template <typename Fn>
-		void add_component_generator(entity_range const range, Fn&& gen) {
-			// Return type of 'func'
-			using ComponentType = decltype(std::declval<Fn>()(entity_id{0}));
-			static_assert(!std::is_same_v<ComponentType, void>, "Initializer functions must return a component");
-
-			if constexpr (detail::is_parent<std::remove_cvref_t<ComponentType>>::value) {
-				auto const converter = [gen = std::forward<Fn>(gen)](entity_id id) {
-					return detail::parent_id{gen(id).id()};
-				};
+		// Moves a range of components to a range of entities. Will not be added until 'commit_changes()' is called.
+		// Pre: entity does not already have the component, or have it in queue to be added
+		// Pre: range and span must be same size
+		template <std::ranges::contiguous_range R>
+		requires(!std::is_lvalue_reference_v<R> && !std::is_const_v<R>)
+		void add_component_span(entity_range const range, R&& vals) {
+			static_assert(std::ranges::sized_range<R>, "Size of span is needed.");
+			using T = std::remove_cvref_t<std::ranges::range_reference_t<R>>;
 
-				auto& pool = ctx.get_component_pool<detail::parent_id>();
-				PreAudit(!pool.has_entity(range), "one- or more entities in the range already has this type");
-				pool.add_generator(range, converter);
+			if constexpr (detail::is_parent<T>::value) {
+				add_component_span(range, static_cast<R const&>(vals));
 			} else {
-				auto& pool = ctx.get_component_pool<ComponentType>();
+				static_assert(!detail::global<T>, "can not add global components to entities");
+				static_assert(!std::is_pointer_v<T>, "can not add pointers to entities; wrap them in a struct");
+				static_assert(std::move_constructible<T>, "Type must be movable");
+
+				Pre(range.ucount() == std::size(vals), "range and span must be same size");
+
+				detail::component_pool<T>& pool = ctx.get_component_pool<T>();
 				PreAudit(!pool.has_entity(range), "one- or more entities in the range already has this type");
-				pool.add_generator(range, std::forward<Fn>(gen));
+				if constexpr (std::is_same_v<R, std::vector<T>>) {
+					pool.add_span(range, std::move(vals));
+				} else {
+					std::vector<T> vec;
+					vec.reserve(range.ucount());
+					std::ranges::move(vals, std::back_inserter(vec));
+					pool.add_span(range, std::move(vec));
+				}
 			}
 		}
 
+		// Adopts a buffer of components for a range of entities. Will not be added until 'commit_changes()' is called.
+		// The memory of the buffer is used to store the components, unless the range fills a gap in existing components,
+		// in which case the components are moved out of the buffer.
+		// Pre: entity does not already have the component, or have it in queue to be added
+		// Pre: range and buffer must be same size
+		template <typename T>
+		void adopt_component_buffer(entity_range const range, unique_buffer<T>&& buffer) {
+			static_assert(!detail::global<T>, "can not add global components to entities");
+			static_assert(!detail::unbound<T>, "tag components have no data to adopt");
+			static_assert(!detail::soa<T>, "buffers of 'soa' components are not laid out as structures of arrays");
+			static_assert(!detail::shared<T>, "'share' components store one component per run, not per entity");
+			static_assert(!detail::is_parent<T>::value, "can not adopt buffers of parents");
+
+			detail::component_pool<T>& pool = ctx.get_component_pool<T>();
+			PreAudit(!pool.has_entity(range), "one- or more entities in the range already has this type");
+			pool.adopt(range, std::move(buffer));
+		}
+
+		template <typename Fn>
+		void add_component_generator(entity_range const range, Fn&& gen) {
+			add_generator(range, std::forward<Fn>(gen), false);
+		}
+
+		// Like 'add_component_generator', but large ranges are constructed in parallel during the commit.
+		// The generator may be called concurrently and out of order, so it must not depend on state shared between calls.
+		template <typename Fn>
+		void add_component_generator(std::execution::parallel_policy const&, entity_range const range, Fn&& gen) {
+			add_generator(range, std::forward<Fn>(gen), true);
+		}
+
 		// Add several components to an entity. Will not be added until 'commit_changes()' is called.
 		// Pre: entity does not already have the component, or have it in queue to be added
 		template <typename... T>
@@ -128,36 +176,119 @@ namespace ecs {
 			remove_component<T>({id, id});
 		}
 
+		// Returns a range of 'count' new entities. The ids of destroyed entities are reused, preferring the
+		// smallest gap between existing entities that fits the range, so components stay in few, large chunks.
+		// Can be called from any thread.
+		// NOTE: Ids chosen by the caller are not known to the runtime, and might be handed out again
+		// Pre: count > 0
+		entity_range create_entities(std::ptrdiff_t const count) {
+			return ctx.create_entities(count);
+		}
+
+		// Removes all the components from a range of entities, and makes their ids available to 'create_entities'.
+		// The components will not be removed until 'commit_changes()' is called, and that includes components
+		// added to the entities before they were destroyed. The ids are not reused until then either.
+		// Pre: the entities were returned by 'create_entities', and have not been destroyed already
+		void destroy_entities(entity_range const range) {
+			ctx.destroy_entities(range);
+		}
+
+		// Returns the number of entities returned by 'create_entities' that have not been destroyed
+		std::ptrdiff_t get_created_entity_count() {
+			return ctx.get_created_entity_count();
+		}
+
+		// Takes the commands recorded in a command buffer, and leaves the buffer empty.
+		// The commands are applied when 'commit_changes()' is called. Can be called from any thread.
+		void submit(command_buffer&& buffer) {
+			ctx.submit_commands(std::move(buffer.lists));
+			buffer.clear();
+		}
+
 		// Returns a global component.
 		template <detail::global T>
 		T& get_global_component() {
 			return ctx.get_component_pool<T>().get_shared_component();
 		}
 
-		// Returns the component from an entity, or nullptr if the entity is not found
+		// Returns the component from an entity, or nullptr if the entity is not found.
+		// Double-buffered components return the value for the next cycle.
 		// NOTE: Pointers to components are only guaranteed to be valid
 		//       until the next call to 'runtime::commit_changes' or 'runtime::update',
 		//       after which the component might be reallocated.
 		template <detail::local T>
-		T* get_component(entity_id const id) {
+		T* get_component(entity_id const id) requires(!detail::soa<T> && !detail::shared<T>) {
 			// Get the component pool
 			detail::component_pool<T>& pool = ctx.get_component_pool<T>();
+			if constexpr (detail::double_buffered<T>)
+				return pool.find_next_component_data(id);
+			else
+				return pool.find_component_data(id);
+		}
+
+		// Returns the shared component of an entity, or nullptr if the entity is not found.
+		// The component is shared with the other entities in its run, so it can not be written to.
+		// Use 'runtime::set_shared_component' to change it.
+		template <detail::shared T>
+		T const* get_component(entity_id const id) {
+			detail::component_pool<T> const& pool = ctx.get_component_pool<T>();
 			return pool.find_component_data(id);
 		}
 
+		// Changes the shared component of a range of entities. Runs that are only partly in the range are split,
+		// so the other entities in them keep their component. Will not be changed until 'commit_changes()' is called.
+		// Pre: the entities have the component
+		template <detail::shared T>
+		void set_shared_component(entity_range const range, T const& val) {
+			detail::component_pool<T>& pool = ctx.get_component_pool<T>();
+			Pre(pool.has_entity(range), "one- or more entities in the range does not have this type");
+			pool.assign(range, val);
+		}
+
+		// Returns a reference to the component from an entity, or an empty reference if the entity is not found
+		// NOTE: References to components are only guaranteed to be valid
+		//       until the next call to 'runtime::commit_changes' or 'runtime::update',
+		//       after which the component might be reallocated.
+		template <detail::local T>
+		soa_ref<T> get_component(entity_id const id) requires(detail::soa<T>) {
+			// Get the component pool
+			detail::component_pool<T>& pool = ctx.get_component_pool<T>();
+			return pool.find_component_ref(id);
+		}
+
 		// Returns the components from an entity range, or an empty span if the entities are not found
 		// or does not contain the component.
+		// The components must be stored in a single chunk; use 'get_component_spans' for ranges that span several chunks.
 		// NOTE: Pointers to components are only guaranteed to be valid
 		//       until the next call to 'runtime::commit_changes' or 'runtime::update',
 		//       after which the component might be reallocated.
 		template <detail::local T>
-		std::span<T> get_components(entity_range const range) {
+		std::span<T> get_components(entity_range const range) requires(!detail::soa<T> && !detail::shared<T>) {
 			if (!has_component<T>(range))
 				return {};
 
 			// Get the component pool
 			detail::component_pool<T>& pool = ctx.get_component_pool<T>();
-			return {pool.find_component_data(range.first()), range.ucount()};
+			if constexpr (detail::double_buffered<T>)
+				return {pool.find_next_component_data(range.first()), range.ucount()};
+			else
+				return {pool.find_component_data(range.first()), range.ucount()};
+		}
+
+		// Returns the components from an entity range as a range of 'std::span<T>', with one span for each run of
+		// components that are contiguous in memory. Returns an empty view if the entities are not found
+		// or does not contain the component.
+		// NOTE: The view and the spans are only guaranteed to be valid
+		//       until the next call to 'runtime::commit_changes' or 'runtime::update',
+		//       after which the component might be reallocated.
+		template <detail::local T>
+		auto get_component_spans(entity_range const range) requires(!detail::tagged<T> && !detail::soa<T> && !detail::shared<T>) {
+			// Get the component pool
+			detail::component_pool<T> const& pool = ctx.get_component_pool<T>();
+			if constexpr (detail::double_buffered<T>)
+				return pool.get_next_component_spans(range);
+			else
+				return pool.get_component_spans(range);
 		}
 
 		// Returns the number of active components for a specific type of components
@@ -176,6 +307,16 @@ namespace ecs {
 			return pool.num_entities();
 		}
 
+		// Returns the sorted ranges of entities whose components have been added
+		// or written to by systems since the last call to 'runtime::commit_changes'.
+		// NOTE: The returned view is only guaranteed to be valid
+		//       until the next call to 'runtime::commit_changes', 'runtime::run_systems' or 'runtime::update'.
+		template <detail::local T>
+		entity_range_view get_modified_ranges() {
+			detail::component_pool<T> const& pool = ctx.get_component_pool<T>();
+			return pool.get_modified_ranges();
+		}
+
 		// Return true if an entity contains the component
 		template <typename T>
 		bool has_component(entity_id const id) {
@@ -231,28 +372,113 @@ namespace ecs {
 			}
 		}
 
-		// Set the memory resource to use to store a specific type of component
-		/*template <typename Component>
+		// Set the memory resource to use to store a specific type of component.
+		// Components already added are moved to memory from the new resource.
+		template <detail::local Component>
 		void set_memory_resource(std::pmr::memory_resource* resource) {
 			auto& pool = ctx.get_component_pool<Component>();
 			pool.set_memory_resource(resource);
+			ctx.rebuild_systems<Component>();
 		}
 
 		// Returns the memory resource used to store a specific type of component
-		template <typename Component>
+		template <detail::local Component>
 		std::pmr::memory_resource* get_memory_resource() {
 			auto& pool = ctx.get_component_pool<Component>();
 			return pool.get_memory_resource();
 		}
 
 		// Resets the memory resource to the default
-		template <typename Component>
+		template <detail::local Component>
 		void reset_memory_resource() {
+			set_memory_resource<Component>(std::pmr::get_default_resource());
+		}
+
+		// Merges the chunks of a type of component that hold adjacent entities into single allocations,
+		// and releases memory that is not used by any entities.
+		// NOTE: Pointers to the components are invalidated
+		template <detail::local Component>
+		defragment_result defragment() {
 			auto& pool = ctx.get_component_pool<Component>();
-			pool.set_memory_resource(std::pmr::get_default_resource());
-		}*/
+			defragment_result const result = pool.defragment();
+			if (result)
+				ctx.rebuild_systems<Component>();
+			return result;
+		}
+
+		// Allocates memory for a type of component for a range of entities, without adding any components.
+		// Components that are later added to entities in the range are stored in that memory,
+		// so the range ends up in a single chunk instead of one chunk per add.
+		// The unused part of a reservation is released by 'defragment()', and a reservation is
+		// released entirely if an add only partially overlaps it.
+		// Can not be called from more than one thread at a time, or while systems are running.
+		// Pre: no entities in the range has the component, and the range is not already reserved
+		template <detail::persistent Component>
+		void reserve(entity_range const range) requires(!detail::unbound<Component> && !detail::shared<Component>) {
+			ctx.reserve<Component>(range);
+		}
+
+		// Sets the fragmentation at which a type of component is defragmented during 'commit_changes()'.
+		// The fragmentation is the share of chunks that could be merged or that has unused memory.
+		// A threshold of zero disables automatic defragmentation, which is the default.
+		template <detail::local Component>
+		void set_defragment_threshold(float const threshold) {
+			auto& pool = ctx.get_component_pool<Component>();
+			pool.set_defragment_threshold(threshold);
+		}
+
+		// Returns the share of a transient components chunk allocations that reused memory from earlier cycles
+		template <detail::transient Component>
+		float get_memory_reuse_rate() {
+			auto const& pool = ctx.get_component_pool<Component>();
+			return pool.get_memory_reuse_rate();
+		}
+
+		// Returns the memory used by each type of component, in the order the types were first used.
+		// NOTE: Must not be called while changes are being committed
+		std::vector<component_memory_report> memory_report() {
+			return ctx.get_memory_report();
+		}
+
+		// Writes the components of all trivially copyable types to a file.
+		// Changes that have not been committed are not written, and neither are 'transient' and 'soa' components.
+		// Returns false if the file could not be written.
+		bool save_snapshot(std::filesystem::path const& path) {
+			return ctx.save_snapshot(path);
+		}
+
+		// Replaces all the components with the ones in a snapshot written by 'save_snapshot', and commits the changes.
+		// Components that have not been used in this runtime must be passed in 'Components'.
+		// Returns false if the snapshot could not be read, in which case all components are removed.
+		// NOTE: Snapshots can only be loaded by builds made with the same compiler and platform
+		template <typename... Components>
+		bool load_snapshot(std::filesystem::path const& path) {
+			(ctx.get_component_pool<std::remove_cvref_t<Components>>(), ...);
+			return ctx.load_snapshot(path);
+		}
 
 	private:
+		template <typename Fn>
+		void add_generator(entity_range const range, Fn&& gen, bool const parallel) {
+			// Return type of 'func'
+			using ComponentType = decltype(std::declval<Fn>()(entity_id{0}));
+			static_assert(!std::is_same_v<ComponentType, void>, "Initializer functions must return a component");
+
+			if constexpr (detail::is_parent<std::remove_cvref_t<ComponentType>>::value) {
+				auto const converter = [gen = std::forward<Fn>(gen)](entity_id id) {
+					return detail::parent_id{gen(id).id()};
+				};
+
+				auto& pool = ctx.get_component_pool<detail::parent_id>();
+				PreAudit(!pool.has_entity(range), "one- or more entities in the range already has this type");
+				pool.add_generator(range, converter, parallel);
+			} else {
+				auto& pool = ctx.get_component_pool<ComponentType>();
+				PreAudit(!pool.has_entity(range), "one- or more entities in the range already has this type");
+				pool.add_generator(range, std::forward<Fn>(gen), parallel);
+			}
+		}
+
 		detail::context ctx;
 	};
 
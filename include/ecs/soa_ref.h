@@ -0,0 +1,241 @@
+#ifndef ECS_SOA_REF_H
+#define ECS_SOA_REF_H
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "flags.h"
+
+namespace ecs::detail {
+// Converts to anything. Used to count the members of aggregates
+struct soa_any_member {
+	template <typename U>
+	operator U() const noexcept;
+};
+
+// Returns the number of members in an aggregate
+template <typename T, typename... Members>
+consteval std::size_t soa_member_count() {
+	if constexpr (requires { T{Members{}..., soa_any_member{}}; })
+		return soa_member_count<T, Members..., soa_any_member>();
+	else
+		return sizeof...(Members);
+}
+
+// Returns a tuple of references to the members of an aggregate
+template <typename T>
+constexpr auto soa_tie(T& t) noexcept {
+	constexpr std::size_t count = soa_member_count<std::remove_const_t<T>>();
+	static_assert(count > 0 && count <= 8, "components flagged as 'soa' must have between 1 and 8 members");
+
+	if constexpr (count == 1) {
+		auto& [a] = t;
+		return std::tie(a);
+	} else if constexpr (count == 2) {
+		auto& [a, b] = t;
+		return std::tie(a, b);
+	} else if constexpr (count == 3) {
+		auto& [a, b, c] = t;
+		return std::tie(a, b, c);
+	} else if constexpr (count == 4) {
+		auto& [a, b, c, d] = t;
+		return std::tie(a, b, c, d);
+	} else if constexpr (count == 5) {
+		auto& [a, b, c, d, e] = t;
+		return std::tie(a, b, c, d, e);
+	} else if constexpr (count == 6) {
+		auto& [a, b, c, d, e, f] = t;
+		return std::tie(a, b, c, d, e, f);
+	} else if constexpr (count == 7) {
+		auto& [a, b, c, d, e, f, g] = t;
+		return std::tie(a, b, c, d, e, f, g);
+	} else {
+		auto& [a, b, c, d, e, f, g, h] = t;
+		return std::tie(a, b, c, d, e, f, g, h);
+	}
+}
+
+// Converts a tuple of references into a tuple of pointers
+template <typename Tuple>
+struct soa_pointer_tuple;
+template <typename... Members>
+struct soa_pointer_tuple<std::tuple<Members&...>> {
+	using type = std::tuple<Members*...>;
+};
+
+// The layout of components stored as a structure of arrays.
+// Each member is stored in its own array, one after the other.
+template <typename T>
+struct soa_layout {
+	using value_type = std::remove_const_t<T>;
+	static_assert(std::is_aggregate_v<value_type> && std::is_trivially_copyable_v<value_type>,
+				  "components flagged as 'soa' must be trivially copyable aggregates");
+
+	// A tuple of pointers to each member
+	using pointers = typename soa_pointer_tuple<decltype(soa_tie(std::declval<T&>()))>::type;
+
+	static constexpr std::size_t num_members = std::tuple_size_v<pointers>;
+
+	template <std::size_t I>
+	using member_type = std::remove_pointer_t<std::tuple_element_t<I, pointers>>;
+
+	// The gap between member arrays. Large chunks would otherwise place the members of a component
+	// at the same offset in different pages, which causes false dependencies between loads and stores.
+	static constexpr std::size_t member_gap = 64;
+
+	// Returns the byte offset of each members array when storing 'count' components.
+	// The last element holds the total size.
+	static constexpr std::array<std::size_t, num_members + 1> offsets(std::size_t const count) noexcept {
+		std::array<std::size_t, num_members + 1> result{};
+		[&]<std::size_t... I>(std::index_sequence<I...>) {
+			std::size_t offset = 0;
+			((offset = (offset + alignof(member_type<I>) - 1) & ~(alignof(member_type<I>) - 1),
+			  result[I] = offset,
+			  offset += count * sizeof(member_type<I>) + member_gap), ...);
+			result[num_members] = offset - member_gap;
+		}(std::make_index_sequence<num_members>{});
+		return result;
+	}
+
+	// Returns the number of bytes needed to store 'count' components
+	static constexpr std::size_t size(std::size_t const count) noexcept {
+		return offsets(count)[num_members];
+	}
+
+	// Returns pointers to the members of the component at 'index' in data holding 'count' components
+	static pointers members(void* data, std::size_t const count, std::size_t const index) noexcept {
+		auto const offs = offsets(count);
+		auto* const bytes = static_cast<std::byte*>(data);
+		return [&]<std::size_t... I>(std::index_sequence<I...>) {
+			return pointers{(reinterpret_cast<member_type<I>*>(bytes + offs[I]) + index)...};
+		}(std::make_index_sequence<num_members>{});
+	}
+
+	// Copies 'num' components between two allocations holding 'from_count' and 'to_count' components
+	static void copy(void* from, std::size_t const from_count, std::size_t const from_index,
+					 void* to, std::size_t const to_count, std::size_t const to_index, std::size_t const num) noexcept {
+		pointers const src = members(from, from_count, from_index);
+		pointers const dst = members(to, to_count, to_index);
+		[&]<std::size_t... I>(std::index_sequence<I...>) {
+			(std::memcpy(std::get<I>(dst), std::get<I>(src), num * sizeof(member_type<I>)), ...);
+		}(std::make_index_sequence<num_members>{});
+	}
+};
+
+struct soa_access;
+} // namespace ecs::detail
+
+namespace ecs {
+// A reference to a component flagged as 'soa'. Its members are stored in separate arrays,
+// so it can not be passed to systems as a regular reference.
+// Use 'soa_ref<T>' in systems to read and write the component, and 'soa_ref<T const>' to only read it.
+// The members are accessed with 'get<I>()' or structured bindings, eg. 'auto [x, y] = ref;'
+ECS_EXPORT template <typename T>
+class soa_ref {
+	using layout = detail::soa_layout<T>;
+	using pointers = typename layout::pointers;
+
+public:
+	using element_type = T;
+	using value_type = std::remove_const_t<T>;
+	using ecs_flags = typename value_type::ecs_flags;
+
+	static constexpr std::size_t num_members = layout::num_members;
+
+	soa_ref() noexcept = default;
+	soa_ref(soa_ref const&) noexcept = default;
+
+	// Writes the referenced component, not the reference
+	soa_ref const& operator=(soa_ref const& other) const noexcept {
+		return *this = other.load();
+	}
+
+	// Writes a component to the referenced members
+	soa_ref const& operator=(value_type const& val) const noexcept requires(!std::is_const_v<T>) {
+		auto const src = detail::soa_tie(val);
+		[&]<std::size_t... I>(std::index_sequence<I...>) {
+			((*std::get<I>(ptrs) = std::get<I>(src)), ...);
+		}(std::make_index_sequence<num_members>{});
+		return *this;
+	}
+
+	// A writeable reference can be used as a read-only reference
+	operator soa_ref<T const>() const noexcept requires(!std::is_const_v<T>) {
+		soa_ref<T const> ref;
+		ref.ptrs = ptrs;
+		return ref;
+	}
+
+	// Returns the member at index 'I'
+	template <std::size_t I>
+	[[nodiscard]] auto& get() const noexcept {
+		return *std::get<I>(ptrs);
+	}
+
+	// Reads the referenced members into a component
+	[[nodiscard]] value_type load() const noexcept {
+		return [&]<std::size_t... I>(std::index_sequence<I...>) {
+			return value_type{get<I>()...};
+		}(std::make_index_sequence<num_members>{});
+	}
+
+	operator value_type() const noexcept {
+		return load();
+	}
+
+	// Returns true if the reference points to a component
+	explicit operator bool() const noexcept {
+		return nullptr != std::get<0>(ptrs);
+	}
+
+private:
+	template <typename>
+	friend class soa_ref;
+	friend struct detail::soa_access;
+
+	pointers ptrs{};
+};
+} // namespace ecs
+
+template <typename T>
+struct std::tuple_size<ecs::soa_ref<T>> : std::integral_constant<std::size_t, ecs::soa_ref<T>::num_members> {};
+
+template <std::size_t I, typename T>
+struct std::tuple_element<I, ecs::soa_ref<T>> {
+	using type = decltype(std::declval<ecs::soa_ref<T> const&>().template get<I>());
+};
+
+namespace ecs::detail {
+// Creates and moves soa references. Used internally
+struct soa_access {
+	// Returns a reference to the component at 'index' in data holding 'count' components
+	template <typename T>
+	static soa_ref<T> make(void* data, std::size_t const count, std::size_t const index) noexcept {
+		soa_ref<T> ref;
+		ref.ptrs = soa_layout<T>::members(data, count, index);
+		return ref;
+	}
+
+	// Returns a reference to the component 'offset' components after 'ref'
+	template <typename T>
+	static soa_ref<T> advance(soa_ref<T> const& ref, std::ptrdiff_t const offset) noexcept {
+		soa_ref<T> result;
+		result.ptrs = std::apply([offset](auto*... p) {
+			return typename soa_layout<T>::pointers{(p + offset)...};
+		}, ref.ptrs);
+		return result;
+	}
+};
+
+// Detect soa references
+template <typename T>
+struct is_soa_ref : std::false_type {};
+template <typename T>
+struct is_soa_ref<soa_ref<T>> : std::true_type {};
+} // namespace ecs::detail
+
+#endif // !ECS_SOA_REF_H
@@ -0,0 +1,94 @@
+#ifndef ECS_UNIQUE_BUFFER_H
+#define ECS_UNIQUE_BUFFER_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <span>
+#include <utility>
+
+namespace ecs {
+// An owning buffer of components, which can be adopted by a runtime with 'adopt_component_buffer'.
+// The memory of an adopted buffer is used to store the components, so they are not copied.
+//
+// The deleter only releases the memory of the buffer. The components are destroyed before it is called.
+ECS_EXPORT template <typename T>
+class unique_buffer {
+public:
+	using deleter_type = std::function<void(T*, std::size_t)>;
+
+	unique_buffer() noexcept = default;
+
+	// Takes ownership of 'size' constructed components in 'data'
+	unique_buffer(T* data, std::size_t size, deleter_type deleter) noexcept
+		: ptr(data), count(size), del(std::move(deleter)) {}
+
+	// Allocates memory for 'size' value-initialized components
+	template <typename Alloc = std::allocator<T>>
+	explicit unique_buffer(std::size_t size, Alloc const& alloc = Alloc{}) : count(size) {
+		using traits = std::allocator_traits<Alloc>;
+		Alloc a{alloc};
+		ptr = traits::allocate(a, size);
+		std::uninitialized_value_construct_n(ptr, size);
+		del = [a](T* data, std::size_t n) mutable {
+			traits::deallocate(a, data, n);
+		};
+	}
+
+	unique_buffer(unique_buffer const&) = delete;
+	unique_buffer& operator=(unique_buffer const&) = delete;
+
+	unique_buffer(unique_buffer&& other) noexcept
+		: ptr(std::exchange(other.ptr, nullptr)), count(std::exchange(other.count, 0)), del(std::move(other.del)) {}
+
+	unique_buffer& operator=(unique_buffer&& other) noexcept {
+		if (this != &other) {
+			reset();
+			ptr = std::exchange(other.ptr, nullptr);
+			count = std::exchange(other.count, 0);
+			del = std::move(other.del);
+		}
+		return *this;
+	}
+
+	~unique_buffer() {
+		reset();
+	}
+
+	T* data() const noexcept {
+		return ptr;
+	}
+
+	std::size_t size() const noexcept {
+		return count;
+	}
+
+	std::span<T> span() const noexcept {
+		return {ptr, count};
+	}
+
+	// Releases ownership of the memory and the components in it, and returns the deleter.
+	// The components must be destroyed before the deleter is called.
+	[[nodiscard]] deleter_type release() noexcept {
+		ptr = nullptr;
+		count = 0;
+		return std::move(del);
+	}
+
+private:
+	void reset() noexcept {
+		if (nullptr != ptr) {
+			std::destroy_n(ptr, count);
+			del(ptr, count);
+			ptr = nullptr;
+			count = 0;
+		}
+	}
+
+	T* ptr = nullptr;
+	std::size_t count = 0;
+	deleter_type del;
+};
+} // namespace ecs
+
+#endif // !ECS_UNIQUE_BUFFER_H
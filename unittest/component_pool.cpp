@@ -1,6 +1,9 @@
 #include <ecs/ecs.h>
+#include <array>
 #include <exception>
+#include <memory>
 #include <numeric>
+#include <string>
 #include <catch2/catch_test_macros.hpp>
 
 // Override the default handler for contract violations.
@@ -34,6 +37,24 @@ struct ctr_counter {
 	ctr_counter& operator=(ctr_counter const&) = default;
 };
 
+// A component stored in cache-line aligned chunks padded for 8-wide vectors
+struct simd_float {
+	using ecs_layout = ecs::layout<64, 8>;
+	float val;
+};
+
+// A component with separate copies for reading and writing
+struct double_buffered_int {
+	using ecs_flags = ecs::flags<ecs::double_buffer>;
+	int value;
+};
+
+// A component whose chunks grow when entities are appended to them
+struct growable_int {
+	using ecs_flags = ecs::flags<ecs::grow>;
+	int value;
+};
+
 // A bunch of tests to ensure that the component_pool behaves as expected
 TEST_CASE("Component pool specification", "[component]") {
 	SECTION("A new component pool is empty") {
@@ -98,6 +119,187 @@ TEST_CASE("Component pool specification", "[component]") {
 				REQUIRE(i == *pool.find_component_data(i));
 			}
 		}
+		SECTION("does not copy components moved into the pool") {
+			size_t const copy_count = ctr_counter::copy_count;
+			ecs::detail::component_pool<ctr_counter> pool;
+			pool.add({0, 0}, ctr_counter{});
+			pool.add({2, 2}, ctr_counter{});
+			pool.add_span({3, 5}, std::vector<ctr_counter>(3));
+			pool.process_changes();
+
+			REQUIRE(5 == pool.num_components());
+			REQUIRE(copy_count == ctr_counter::copy_count);
+		}
+		SECTION("of move-only components is valid") {
+			ecs::detail::component_pool<std::unique_ptr<int>> pool;
+			pool.add({0, 0}, std::make_unique<int>(0));
+			pool.add({1, 1}, std::make_unique<int>(1));
+
+			std::vector<std::unique_ptr<int>> ptrs;
+			for (int i = 5; i <= 9; i++)
+				ptrs.push_back(std::make_unique<int>(i));
+			pool.add_span({5, 9}, std::move(ptrs));
+			pool.process_changes();
+
+			REQUIRE(7 == pool.num_components());
+			REQUIRE(0 == **pool.find_component_data(0));
+			REQUIRE(1 == **pool.find_component_data(1));
+			for (int i = 5; i <= 9; i++)
+				REQUIRE(i == **pool.find_component_data(i));
+
+			// Relocating the components moves them
+			pool.remove({6, 6});
+			pool.process_changes();
+			REQUIRE(pool.defragment());
+			REQUIRE(9 == **pool.find_component_data(9));
+		}
+		SECTION("of a value split over several chunks copies it to every entity") {
+			ecs::detail::component_pool<std::string> pool;
+			pool.add({0, 9}, std::string{"x"});
+			pool.process_changes();
+			pool.remove({5, 9});
+			pool.process_changes();
+
+			// Fills the gap in the existing chunk, and puts the last entity in a new chunk
+			std::string const value(32, 'h');
+			pool.add({5, 10}, std::string{value});
+			pool.process_changes();
+
+			for (ecs::entity_id id = 5; id <= 10; ++id)
+				REQUIRE(value == *pool.find_component_data(id));
+		}
+		SECTION("with a span over several chunks is valid") {
+			std::vector<int> ints(11);
+			std::iota(ints.begin(), ints.end(), 4);
+
+			ecs::detail::component_pool<int> pool;
+			pool.add({0, 9}, 0);
+			pool.process_changes();
+			pool.remove({2, 3});
+			pool.remove({4, 9});
+			pool.process_changes();
+			pool.add_span({4, 14}, ints);
+			pool.process_changes();
+
+			for (int i = 4; i <= 14; i++)
+				REQUIRE(i == *pool.find_component_data(i));
+		}
+		SECTION("by adopting a buffer uses its memory") {
+			size_t const copy_count = ctr_counter::copy_count;
+			size_t const move_count = ctr_counter::move_count;
+			bool released = false;
+			ecs::unique_buffer<ctr_counter> buffer{std::allocator<ctr_counter>{}.allocate(10), 10, [&released](ctr_counter* p, std::size_t n) {
+				std::allocator<ctr_counter>{}.deallocate(p, n);
+				released = true;
+			}};
+			std::uninitialized_default_construct_n(buffer.data(), buffer.size());
+			ctr_counter const* const data = buffer.data();
+
+			ecs::detail::component_pool<ctr_counter> pool;
+			pool.adopt({0, 9}, std::move(buffer));
+			pool.process_changes();
+
+			REQUIRE(10 == pool.num_components());
+			REQUIRE(data == pool.find_component_data(0));
+			REQUIRE(data + 9 == pool.find_component_data(9));
+			REQUIRE(copy_count == ctr_counter::copy_count);
+			REQUIRE(move_count == ctr_counter::move_count);
+
+			// Removing all the components releases the buffer
+			pool.remove({0, 9});
+			pool.process_changes();
+			REQUIRE(released);
+		}
+		SECTION("by adopting a buffer that fills a gap moves the components") {
+			ecs::unique_buffer<int> buffer(4);
+			std::iota(buffer.data(), buffer.data() + 4, 3);
+
+			ecs::detail::component_pool<int> pool;
+			pool.add({0, 9}, 0);
+			pool.process_changes();
+			pool.remove({3, 6});
+			pool.process_changes();
+			pool.adopt({3, 6}, std::move(buffer));
+			pool.process_changes();
+
+			REQUIRE(10 == pool.num_components());
+			for (int i = 3; i <= 6; i++)
+				REQUIRE(i == *pool.find_component_data(i));
+			REQUIRE(pool.find_component_data(0) + 9 == pool.find_component_data(9));
+		}
+		SECTION("from generators calls them in order unless they are parallel") {
+			constexpr int count = 100'000;
+			ecs::detail::component_pool<int> pool;
+			int next = 0;
+			int out_of_order = 0;
+			pool.add_generator({0, count - 1}, [&](ecs::entity_id id) {
+				out_of_order += (id != next);
+				next = id + 1;
+				return next;
+			});
+			pool.process_changes();
+
+			REQUIRE(0 == out_of_order);
+			REQUIRE(count == *pool.find_component_data(count - 1));
+		}
+		SECTION("in large batches is valid") {
+			constexpr int count = 100'000;
+			std::vector<int> ints(count);
+			std::iota(ints.begin(), ints.end(), count);
+
+			ecs::detail::component_pool<int> pool;
+			pool.add_generator({0, count - 1}, [](ecs::entity_id id) { return int{id}; }, true);
+			pool.add_span({count, 2 * count - 1}, ints);
+			for (int i = 3 * count - 2; i >= 2 * count; i -= 2)
+				pool.add({i, i}, i);
+			pool.process_changes();
+
+			REQUIRE(2 * count + count / 2 == pool.num_components());
+			int errors = 0;
+			for (int i = 0; i < 3 * count; i++) {
+				int const* const ptr = pool.find_component_data(i);
+				if (i >= 2 * count && (i % 2) == 1)
+					errors += (nullptr != ptr);
+				else
+					errors += (nullptr == ptr || i != *ptr);
+			}
+			REQUIRE(0 == errors);
+		}
+		SECTION("with large or move-only generators is valid") {
+			std::array<int, 64> offsets{};
+			offsets.fill(3);
+			auto ptr = std::make_unique<int>(5);
+
+			ecs::detail::component_pool<int> pool;
+			pool.add_generator({0, 9}, [offsets](ecs::entity_id id) { return id + offsets[0]; });
+			pool.add_generator({10, 19}, [p = std::move(ptr)](ecs::entity_id id) { return id + *p; });
+			pool.process_changes();
+
+			REQUIRE(20 == pool.num_components());
+			for (int i = 0; i <= 9; i++)
+				REQUIRE(i + 3 == *pool.find_component_data(i));
+			for (int i = 10; i <= 19; i++)
+				REQUIRE(i + 5 == *pool.find_component_data(i));
+		}
+		SECTION("of trivially copyable components without operator== merges equal values") {
+			struct pod {
+				int x, y;
+			};
+			static_assert(std::has_unique_object_representations_v<pod>);
+
+			ecs::detail::component_pool<pod> pool;
+			pool.add({0, 4}, pod{1, 2});
+			pool.add({5, 9}, pod{1, 2});
+			pool.add({10, 14}, pod{3, 4});
+			pool.process_changes();
+
+			REQUIRE(15 == pool.num_components());
+			REQUIRE(2 == pool.num_chunks());
+			for (int i = 0; i <= 9; i++)
+				REQUIRE(2 == pool.find_component_data(i)->y);
+			for (int i = 10; i <= 14; i++)
+				REQUIRE(4 == pool.find_component_data(i)->y);
+		}
 		SECTION("with negative entity ids is fine") {
 			ecs::detail::component_pool<int> pool;
 			pool.add({-999, -950}, 0);
@@ -145,6 +347,107 @@ TEST_CASE("Component pool specification", "[component]") {
 		}
 	}
 
+	SECTION("Modified components") {
+		SECTION("added components are flagged as modified") {
+			ecs::detail::component_pool<int> pool;
+			pool.add({0, 9}, 0);
+			pool.add({20, 29}, 0);
+			pool.process_changes();
+
+			std::vector<ecs::entity_range> const expected{{0, 9}, {20, 29}};
+			REQUIRE(std::ranges::equal(expected, pool.get_modified_ranges()));
+			CHECK(pool.is_modified({5, 5}));
+			CHECK(pool.is_modified({8, 22}));
+			CHECK(!pool.is_modified({10, 19}));
+			CHECK(!pool.is_modified({30, 40}));
+		}
+
+		SECTION("components filling gaps are flagged as modified") {
+			ecs::detail::component_pool<int> pool;
+			pool.add({0, 9}, 0);
+			pool.process_changes();
+			pool.remove({5, 9});
+			pool.process_changes();
+			std::uint64_t const removed_version = pool.get_change_version();
+
+			// Fills the gap in the existing chunk, and puts the last entity in a new chunk
+			pool.add({5, 10}, 1);
+			pool.process_changes();
+
+			std::vector<ecs::entity_range> const expected{{5, 10}};
+			REQUIRE(std::ranges::equal(expected, pool.get_modified_ranges()));
+			REQUIRE(std::ranges::equal(expected, pool.get_changed_ranges(removed_version)));
+		}
+
+		SECTION("modified ranges are combined") {
+			ecs::detail::component_pool<int> pool;
+			pool.add({0, 99}, 0);
+			pool.process_changes();
+			pool.clear_flags();
+			pool.process_changes();
+			REQUIRE(pool.get_modified_ranges().empty());
+			REQUIRE(!pool.has_components_been_modified());
+
+			std::vector<ecs::entity_range> const first{{10, 19}, {40, 49}};
+			pool.notify_components_modified(first);
+			std::vector<ecs::entity_range> const second{{20, 29}, {45, 59}};
+			pool.notify_components_modified(second);
+
+			std::vector<ecs::entity_range> const expected{{10, 29}, {40, 59}};
+			REQUIRE(std::ranges::equal(expected, pool.get_modified_ranges()));
+			REQUIRE(pool.has_components_been_modified());
+		}
+
+		SECTION("modified ranges are cleared on the next commit") {
+			ecs::detail::component_pool<int> pool;
+			pool.add({0, 9}, 0);
+			pool.process_changes();
+			REQUIRE(!pool.get_modified_ranges().empty());
+
+			pool.process_changes();
+			REQUIRE(pool.get_modified_ranges().empty());
+		}
+
+		SECTION("changed ranges are kept across commits") {
+			ecs::detail::component_pool<int> pool;
+			pool.add({0, 9}, 0);
+			pool.process_changes();
+			std::uint64_t const added_version = pool.get_change_version();
+			pool.process_changes();
+
+			std::vector<ecs::entity_range> const added{{0, 9}};
+			REQUIRE(std::ranges::equal(added, pool.get_changed_ranges(0)));
+			REQUIRE(pool.get_changed_ranges(added_version).empty());
+
+			std::vector<ecs::entity_range> const written{{2, 4}};
+			pool.notify_components_modified(written);
+			REQUIRE(std::ranges::equal(written, pool.get_changed_ranges(added_version)));
+			REQUIRE(std::ranges::equal(added, pool.get_changed_ranges(0)));
+
+			// removed components are no longer tracked
+			pool.remove({0, 2});
+			pool.process_changes();
+			std::vector<ecs::entity_range> const remaining{{3, 4}};
+			REQUIRE(std::ranges::equal(remaining, pool.get_changed_ranges(added_version)));
+		}
+
+		SECTION("changed ranges keep versions past 32 bits") {
+			ecs::detail::component_pool<int> pool;
+			pool.set_change_version(std::uint64_t{0xFFFF'FFFF});
+			pool.add({0, 9}, 0);
+			pool.process_changes();
+			std::uint64_t const added_version = pool.get_change_version();
+			REQUIRE(added_version == std::uint64_t{1} << 32);
+
+			std::vector<ecs::entity_range> const written{{2, 4}};
+			pool.notify_components_modified(written);
+
+			std::vector<ecs::entity_range> const added{{0, 9}};
+			REQUIRE(std::ranges::equal(added, pool.get_changed_ranges(0)));
+			REQUIRE(std::ranges::equal(written, pool.get_changed_ranges(added_version)));
+		}
+	}
+
 	SECTION("Removing components") {
 		SECTION("from the back does not invalidate other components") {
 			std::vector<int> ints(11);
@@ -319,6 +622,340 @@ TEST_CASE("Component pool specification", "[component]") {
 			auto const ev = pool.get_entities();
 			REQUIRE(ev.current()->first() == -2);
 		}
+
+		SECTION("use a bitset when the entities are scattered") {
+			struct some_tag {
+				using ecs_flags = ecs::flags<ecs::tag>;
+			};
+			ecs::detail::component_pool<some_tag> pool;
+			pool.add({0, 999}, {});
+			pool.process_changes();
+			CHECK(nullptr == pool.get_tag_bitset());
+
+			pool.remove({0, 999});
+			for (int i = 0; i < 1000; i += 3)
+				pool.add({i, i}, {});
+			pool.process_changes();
+			CHECK(nullptr != pool.get_tag_bitset());
+
+			pool.clear();
+			CHECK(nullptr == pool.get_tag_bitset());
+		}
+	}
+
+	SECTION("Indexed components") {
+		struct idx_int {
+			using ecs_flags = ecs::flags<ecs::indexed>;
+			int v;
+		};
+
+		SECTION("finds components in fragmented pools") {
+			ecs::detail::component_pool<idx_int> pool;
+			for (int i = -100; i < 100; i += 3) {
+				pool.add({i, i + 1}, idx_int{i});
+			}
+			pool.process_changes();
+
+			for (int i = -100; i < 100; i += 3) {
+				REQUIRE(i == pool.find_component_data(i)->v);
+				REQUIRE(i == pool.find_component_data(i + 1)->v);
+				REQUIRE(nullptr == pool.find_component_data(i + 2));
+			}
+			REQUIRE(nullptr == pool.find_component_data(-101));
+			REQUIRE(nullptr == pool.find_component_data(std::numeric_limits<int>::min()));
+			REQUIRE(nullptr == pool.find_component_data(std::numeric_limits<int>::max()));
+		}
+
+		SECTION("is updated when components are removed") {
+			ecs::detail::component_pool<idx_int> pool;
+			pool.add({0, 99}, idx_int{1});
+			pool.process_changes();
+			pool.remove({10, 89});
+			pool.process_changes();
+
+			REQUIRE(nullptr != pool.find_component_data(9));
+			REQUIRE(nullptr == pool.find_component_data(10));
+			REQUIRE(nullptr == pool.find_component_data(89));
+			REQUIRE(nullptr != pool.find_component_data(90));
+		}
+
+		SECTION("falls back to searching on sparse pools") {
+			ecs::detail::component_pool<idx_int> pool;
+			pool.add({-2'000'000'000, -2'000'000'000}, idx_int{1});
+			pool.add({2'000'000'000, 2'000'000'000}, idx_int{2});
+			pool.process_changes();
+
+			REQUIRE(1 == pool.find_component_data(-2'000'000'000)->v);
+			REQUIRE(2 == pool.find_component_data(2'000'000'000)->v);
+			REQUIRE(nullptr == pool.find_component_data(0));
+		}
+	}
+
+	SECTION("Soa components") {
+		struct soa_pos {
+			using ecs_flags = ecs::flags<ecs::soa>;
+			char c;
+			double d;
+			short s;
+		};
+
+		SECTION("store each member in its own array") {
+			ecs::detail::component_pool<soa_pos> pool;
+			pool.add_generator({0, 9}, [](ecs::entity_id id) {
+				return soa_pos{static_cast<char>(id), id * 0.5, static_cast<short>(-id)};
+			});
+			pool.process_changes();
+
+			auto const first = pool.find_component_ref(0);
+			auto const second = pool.find_component_ref(1);
+			REQUIRE(&first.get<0>() + 1 == &second.get<0>());
+			REQUIRE(&first.get<1>() + 1 == &second.get<1>());
+			REQUIRE(&first.get<2>() + 1 == &second.get<2>());
+			REQUIRE(0 == reinterpret_cast<std::uintptr_t>(&first.get<1>()) % alignof(double));
+
+			for (int i = 0; i <= 9; i++) {
+				auto const [c, d, s] = pool.find_component_ref(i);
+				REQUIRE(i == c);
+				REQUIRE(i * 0.5 == d);
+				REQUIRE(-i == s);
+			}
+			REQUIRE(!pool.find_component_ref(10));
+		}
+
+		SECTION("can be written through references") {
+			ecs::detail::component_pool<soa_pos> pool;
+			pool.add({0, 9}, soa_pos{1, 2.0, 3});
+			pool.process_changes();
+
+			auto [c, d, s] = pool.find_component_ref(4);
+			c = 4;
+			d = 5.0;
+			pool.find_component_ref(5) = soa_pos{6, 7.0, 8};
+
+			soa_pos const p4 = pool.find_component_ref(4);
+			REQUIRE(4 == p4.c);
+			REQUIRE(5.0 == p4.d);
+			REQUIRE(3 == p4.s);
+			REQUIRE(6 == pool.find_component_ref(5).load().c);
+			REQUIRE(1 == pool.find_component_ref(6).load().c);
+		}
+
+		SECTION("keep their members when chunks are split and filled") {
+			ecs::detail::component_pool<soa_pos> pool;
+			pool.add({0, 9}, soa_pos{1, 2.0, 3});
+			pool.process_changes();
+			pool.remove({3, 6});
+			pool.process_changes();
+			pool.add({4, 5}, soa_pos{4, 5.0, 6});
+			pool.process_changes();
+
+			REQUIRE(3 == pool.num_chunks());
+			REQUIRE(2.0 == pool.find_component_ref(2).get<1>());
+			REQUIRE(!pool.find_component_ref(3));
+			REQUIRE(5.0 == pool.find_component_ref(4).get<1>());
+			REQUIRE(6 == pool.find_component_ref(5).get<2>());
+			REQUIRE(3 == pool.find_component_ref(9).get<2>());
+		}
+	}
+
+	SECTION("Shared components") {
+		struct team {
+			using ecs_flags = ecs::flags<ecs::share>;
+			int id;
+			bool operator==(team const&) const = default;
+		};
+		auto const team_of = [](auto const& pool, ecs::entity_id id) {
+			return pool.find_component_data(id)->id;
+		};
+
+		SECTION("store one component per run") {
+			ecs::detail::component_pool<team> pool;
+			pool.add({0, 99}, team{1});
+			pool.add({100, 199}, team{1});
+			pool.process_changes();
+			CHECK(1 == pool.num_chunks());
+			CHECK(1 == pool.num_components());
+			CHECK(200 == pool.num_entities());
+			CHECK(pool.find_component_data(0) == pool.find_component_data(199));
+
+			std::array<team, 5> const teams{team{1}, team{1}, team{2}, team{2}, team{2}};
+			pool.add_span({200, 204}, teams);
+			pool.process_changes();
+			CHECK(2 == pool.num_chunks());
+			CHECK(1 == team_of(pool, 201));
+			CHECK(2 == team_of(pool, 202));
+		}
+
+		SECTION("split their runs when entities are removed") {
+			ecs::detail::component_pool<team> pool;
+			pool.add({0, 99}, team{1});
+			pool.process_changes();
+
+			pool.remove({40, 59});
+			pool.process_changes();
+			CHECK(2 == pool.num_chunks());
+			CHECK(80 == pool.num_entities());
+			CHECK(1 == team_of(pool, 39));
+			CHECK(1 == team_of(pool, 60));
+			CHECK(nullptr == pool.find_component_data(50));
+
+			// Adding them back joins the runs again
+			pool.add({40, 59}, team{1});
+			pool.process_changes();
+			CHECK(1 == pool.num_chunks());
+		}
+
+		SECTION("split their runs when assigned to") {
+			ecs::detail::component_pool<team> pool;
+			pool.add({0, 99}, team{1});
+			pool.process_changes();
+
+			pool.assign({10, 19}, team{2});
+			pool.process_changes();
+			CHECK(3 == pool.num_chunks());
+			CHECK(1 == team_of(pool, 9));
+			CHECK(2 == team_of(pool, 10));
+			CHECK(2 == team_of(pool, 19));
+			CHECK(1 == team_of(pool, 20));
+
+			pool.assign({10, 19}, team{1});
+			pool.process_changes();
+			CHECK(1 == pool.num_chunks());
+		}
+	}
+
+	SECTION("Double-buffered components") {
+		SECTION("keep the next components until changes are processed") {
+			ecs::detail::component_pool<double_buffered_int> pool;
+			pool.add({0, 9}, double_buffered_int{1});
+			pool.process_changes();
+			CHECK(1 == pool.find_component_data(5)->value);
+			CHECK(1 == pool.find_next_component_data(5)->value);
+			CHECK(pool.find_next_component_data(0) == (*pool.get_next_component_spans({0, 9}).begin()).data());
+
+			pool.find_next_component_data(5)->value = 2;
+			CHECK(1 == pool.find_component_data(5)->value);
+			pool.process_changes();
+			CHECK(2 == pool.find_component_data(5)->value);
+		}
+
+		SECTION("keep both copies when chunks change") {
+			ecs::detail::component_pool<double_buffered_int> pool;
+			pool.add({0, 9}, double_buffered_int{1});
+			pool.process_changes();
+			pool.remove({4, 5});
+			pool.add({10, 19}, double_buffered_int{3});
+			pool.process_changes();
+			pool.defragment();
+
+			for (ecs::entity_id id : {0, 3, 6, 9, 10, 19}) {
+				CHECK(pool.find_component_data(id)->value == pool.find_next_component_data(id)->value);
+			}
+
+			pool.find_next_component_data(19)->value = 4;
+			pool.process_changes();
+			CHECK(4 == pool.find_component_data(19)->value);
+			CHECK(1 == pool.find_component_data(9)->value);
+		}
+
+		SECTION("report the memory of both buffers") {
+			ecs::detail::component_pool<double_buffered_int> pool;
+			pool.add({0, 9}, double_buffered_int{1});
+			pool.process_changes();
+
+			ecs::component_memory_report const report = pool.get_memory_report();
+			REQUIRE(2 * 10 * sizeof(double_buffered_int) == report.bytes_live);
+			REQUIRE(report.bytes_allocated >= report.bytes_live);
+		}
+
+		SECTION("flag writes to the next components when changes are processed") {
+			ecs::detail::component_pool<double_buffered_int> pool;
+			pool.add({0, 9}, double_buffered_int{1});
+			pool.process_changes();
+			std::uint64_t const added_version = pool.get_change_version();
+
+			std::vector<ecs::entity_range> const written{{2, 4}};
+			pool.notify_next_components_modified(written);
+			CHECK(added_version == pool.get_change_version());
+			CHECK(pool.get_changed_ranges(added_version).empty());
+
+			pool.process_changes();
+			REQUIRE(std::ranges::equal(written, pool.get_modified_ranges()));
+			REQUIRE(std::ranges::equal(written, pool.get_changed_ranges(added_version)));
+		}
+	}
+
+	SECTION("Growing components") {
+		SECTION("append into the same chunk") {
+			ecs::detail::component_pool<growable_int> pool;
+			for (int i = 0; i < 10; i++) {
+				pool.add({i * 10, i * 10 + 9}, growable_int{i});
+				pool.process_changes();
+			}
+
+			CHECK(1 == pool.num_chunks());
+			CHECK(100 == pool.num_components());
+			CHECK(0.0f == pool.get_fragmentation());
+			CHECK(ptrdiff_t{99} == std::distance(pool.find_component_data(0), pool.find_component_data(99)));
+			for (int i = 0; i < 10; i++) {
+				CHECK(i == pool.find_component_data(i * 10)->value);
+				CHECK(i == pool.find_component_data(i * 10 + 9)->value);
+			}
+		}
+
+		SECTION("append in a single batch") {
+			ecs::detail::component_pool<growable_int> pool;
+			pool.add({0, 4}, growable_int{0});
+			pool.add({5, 9}, growable_int{1});
+			pool.add({10, 29}, growable_int{2});
+			pool.process_changes();
+
+			CHECK(1 == pool.num_chunks());
+			CHECK(0 == pool.find_component_data(4)->value);
+			CHECK(1 == pool.find_component_data(5)->value);
+			CHECK(2 == pool.find_component_data(29)->value);
+		}
+
+		SECTION("grow geometrically") {
+			ecs::detail::component_pool<growable_int> pool;
+			pool.add({0, 9}, growable_int{0});
+			pool.process_changes();
+			pool.add({10, 10}, growable_int{1});
+			pool.process_changes();
+			REQUIRE(pool.get_head_chunk()->range == ecs::entity_range{0, 19});
+
+			// Appends inside the capacity do not move the components
+			growable_int const* const data = pool.find_component_data(0);
+			pool.add({11, 19}, growable_int{2});
+			pool.process_changes();
+			CHECK(data == pool.find_component_data(0));
+		}
+
+		SECTION("do not grow into the next chunk") {
+			ecs::detail::component_pool<growable_int> pool;
+			pool.add({0, 9}, growable_int{0});
+			pool.add({15, 19}, growable_int{1});
+			pool.process_changes();
+			pool.add({10, 12}, growable_int{2});
+			pool.process_changes();
+
+			REQUIRE(2 == pool.num_chunks());
+			CHECK(pool.get_head_chunk()->range == ecs::entity_range{0, 14});
+			CHECK(2 == pool.find_component_data(12)->value);
+			CHECK(1 == pool.find_component_data(15)->value);
+		}
+
+		SECTION("release the unused capacity when defragmented") {
+			ecs::detail::component_pool<growable_int> pool;
+			pool.add({0, 9}, growable_int{0});
+			pool.process_changes();
+			pool.add({10, 10}, growable_int{1});
+			pool.process_changes();
+
+			ecs::defragment_result const result = pool.defragment();
+			CHECK(9 * sizeof(growable_int) == result.bytes_reclaimed);
+			CHECK(pool.get_head_chunk()->range == ecs::entity_range{0, 10});
+		}
 	}
 
 	SECTION("Global components") {
@@ -334,6 +971,139 @@ TEST_CASE("Component pool specification", "[component]") {
 		}
 	}
 
+	SECTION("Defragmenting") {
+		SECTION("merges chunks with adjacent entities") {
+			ecs::detail::component_pool<int> pool;
+			pool.add_generator({0, 9}, [](ecs::entity_id id) { return int{id}; });
+			pool.process_changes();
+			pool.add_generator({10, 19}, [](ecs::entity_id id) { return int{id}; });
+			pool.process_changes();
+			pool.add_generator({30, 39}, [](ecs::entity_id id) { return int{id}; });
+			pool.process_changes();
+			REQUIRE(3 == pool.num_chunks());
+
+			ecs::defragment_result const result = pool.defragment();
+			REQUIRE(1 == result.chunks_merged);
+			REQUIRE(0 == result.bytes_reclaimed);
+			REQUIRE(2 == pool.num_chunks());
+			REQUIRE(pool.find_component_data(0) + 19 == pool.find_component_data(19));
+			for (int i = 0; i <= 19; i++)
+				REQUIRE(i == *pool.find_component_data(i));
+			REQUIRE(35 == *pool.find_component_data(35));
+
+			REQUIRE(!pool.defragment());
+		}
+
+		SECTION("releases memory not used by any entities") {
+			ecs::detail::component_pool<int> pool;
+			pool.add_generator({0, 19}, [](ecs::entity_id id) { return int{id}; });
+			pool.process_changes();
+			pool.remove({15, 19});
+			pool.remove({5, 9});
+			pool.process_changes();
+			REQUIRE(2 == pool.num_chunks());
+
+			ecs::defragment_result const result = pool.defragment();
+			REQUIRE(0 == result.chunks_merged);
+			REQUIRE(10 * sizeof(int) == result.bytes_reclaimed);
+			REQUIRE(2 == pool.num_chunks());
+			REQUIRE(4 == *pool.find_component_data(4));
+			REQUIRE(nullptr == pool.find_component_data(5));
+			REQUIRE(14 == *pool.find_component_data(14));
+		}
+
+		SECTION("gives split chunks their own memory") {
+			ecs::detail::component_pool<ctr_counter> pool;
+			pool.add({0, 9}, ctr_counter{});
+			pool.process_changes();
+			pool.remove({4, 5});
+			pool.process_changes();
+			REQUIRE(2 == pool.num_chunks());
+
+			size_t const dtr_count = ctr_counter::dtr_count;
+			ecs::defragment_result const result = pool.defragment();
+			REQUIRE(0 == result.chunks_merged);
+			REQUIRE(2 * sizeof(ctr_counter) == result.bytes_reclaimed);
+			REQUIRE(2 == pool.num_chunks());
+			REQUIRE(8 == pool.num_components());
+			REQUIRE(ctr_counter::dtr_count - dtr_count == 8);
+
+			auto chunk = pool.get_head_chunk();
+			REQUIRE(chunk->get_owns_data());
+			REQUIRE(std::next(chunk)->get_owns_data());
+			REQUIRE(false == chunk->get_has_split_data());
+		}
+
+		SECTION("works on soa components") {
+			struct soa_def {
+				using ecs_flags = ecs::flags<ecs::soa>;
+				int i;
+				double d;
+			};
+			ecs::detail::component_pool<soa_def> pool;
+			pool.add_generator({0, 9}, [](ecs::entity_id id) { return soa_def{id, id * 2.0}; });
+			pool.process_changes();
+			pool.add_generator({10, 14}, [](ecs::entity_id id) { return soa_def{id, id * 2.0}; });
+			pool.process_changes();
+
+			REQUIRE(pool.defragment());
+			REQUIRE(1 == pool.num_chunks());
+			for (int i = 0; i <= 14; i++) {
+				auto const [ival, dval] = pool.find_component_ref(i);
+				REQUIRE(i == ival);
+				REQUIRE(i * 2.0 == dval);
+			}
+		}
+
+		SECTION("keeps the index of indexed components up to date") {
+			struct idx_def {
+				using ecs_flags = ecs::flags<ecs::indexed>;
+				int v;
+			};
+			ecs::detail::component_pool<idx_def> pool;
+			pool.add({0, 9}, idx_def{1});
+			pool.process_changes();
+			pool.add({10, 19}, idx_def{2});
+			pool.process_changes();
+
+			REQUIRE(pool.defragment());
+			REQUIRE(1 == pool.find_component_data(9)->v);
+			REQUIRE(2 == pool.find_component_data(10)->v);
+			REQUIRE(nullptr == pool.find_component_data(20));
+		}
+
+		SECTION("merges the ranges of tag components") {
+			struct tag_def {
+				using ecs_flags = ecs::flags<ecs::tag>;
+			};
+			ecs::detail::component_pool<tag_def> pool;
+			pool.add({0, 9}, tag_def{});
+			pool.process_changes();
+			pool.add({10, 19}, tag_def{});
+			pool.process_changes();
+
+			ecs::defragment_result const result = pool.defragment();
+			REQUIRE(1 == result.chunks_merged);
+			REQUIRE(0 == result.bytes_reclaimed);
+			REQUIRE(pool.has_entity({0, 19}));
+		}
+
+		SECTION("happens automatically when the threshold is reached") {
+			ecs::detail::component_pool<int> pool;
+			pool.set_defragment_threshold(0.5f);
+			pool.add({0, 9}, 0);
+			pool.process_changes();
+			pool.add({20, 29}, 0);
+			pool.process_changes();
+			REQUIRE(2 == pool.num_chunks());
+
+			pool.add({10, 19}, 0);
+			pool.process_changes();
+			REQUIRE(1 == pool.num_chunks());
+			REQUIRE(pool.get_fragmentation() == 0.0f);
+		}
+	}
+
 	SECTION("chunked memory") {
 		SECTION("a range of components is contiguous in memory") {
 			ecs::detail::component_pool<int> pool;
@@ -346,6 +1116,24 @@ TEST_CASE("Component pool specification", "[component]") {
 			REQUIRE(ptrdiff_t{2} == std::distance(ptr1, ptr3));
 		}
 
+		SECTION("chunks follow the layout of components") {
+			ecs::detail::component_pool<simd_float> pool;
+			pool.add({1, 5}, simd_float{1.0f});
+			pool.add({10, 20}, simd_float{2.0f});
+			pool.process_changes();
+			CHECK(2 == pool.num_chunks());
+
+			for (ecs::entity_id const ent : {1, 10}) {
+				simd_float const* const data = pool.find_component_data(ent);
+				CHECK(0 == reinterpret_cast<std::uintptr_t>(data) % 64);
+			}
+
+			// The padding after the last component is cleared
+			simd_float const* const data = pool.find_component_data(5);
+			for (int i = 1; i < 4; i++)
+				CHECK(0.0f == data[i].val);
+		}
+
 		SECTION("insertion order forward is correct") {
 			ecs::detail::component_pool<int> pool;
 			pool.add({1, 1}, 0);
@@ -514,5 +1302,63 @@ TEST_CASE("Component pool specification", "[component]") {
 			// They should be seperate
 			REQUIRE(chunk->data != std::next(chunk)->data);
 		}
+
+		SECTION("adds in a reserved range fill the same memory") {
+			ecs::detail::component_pool<int> pool;
+			pool.reserve({0, 9});
+			CHECK(10 == pool.num_reserved());
+			CHECK(0 == pool.num_chunks());
+
+			pool.add({4, 5}, 1);
+			pool.process_changes();
+			CHECK(0 == pool.num_reserved());
+			CHECK(1 == pool.num_chunks());
+			REQUIRE(pool.get_head_chunk()->range == ecs::entity_range{0, 9});
+
+			pool.add({0, 1}, 2);
+			pool.add({8, 9}, 3);
+			pool.process_changes();
+			CHECK(3 == pool.num_chunks());
+
+			// Everything shares the reserved memory
+			pool.add({2, 3}, 4);
+			pool.add({6, 7}, 5);
+			pool.process_changes();
+			CHECK(1 == pool.num_chunks());
+			CHECK(ptrdiff_t{9} == std::distance(pool.find_component_data(0), pool.find_component_data(9)));
+			CHECK(2 == *pool.find_component_data(0));
+			CHECK(4 == *pool.find_component_data(3));
+			CHECK(1 == *pool.find_component_data(5));
+			CHECK(3 == *pool.find_component_data(9));
+		}
+
+		SECTION("unused reserved memory is not counted as fragmentation") {
+			ecs::detail::component_pool<int> pool;
+			pool.set_defragment_threshold(0.5f);
+			pool.reserve({0, 19});
+			pool.add({0, 9}, 1);
+			pool.process_changes();
+			CHECK(0.0f == pool.get_fragmentation());
+			REQUIRE(pool.get_head_chunk()->range == ecs::entity_range{0, 19});
+
+			// Splitting the chunk makes the memory fragmented, so it is defragmented
+			pool.remove({4, 5});
+			pool.process_changes();
+			REQUIRE(pool.get_head_chunk()->range == ecs::entity_range{0, 3});
+		}
+
+		SECTION("adds partially in a reserved range release the reservation") {
+			ecs::detail::component_pool<int> pool;
+			pool.reserve({5, 9});
+			pool.add({0, 6}, 1);
+			pool.process_changes();
+			CHECK(0 == pool.num_reserved());
+			REQUIRE(pool.get_head_chunk()->range == ecs::entity_range{0, 6});
+
+			pool.add({7, 9}, 2);
+			pool.process_changes();
+			CHECK(2 == pool.num_chunks());
+			CHECK(10 == pool.num_components());
+		}
 	}
 }
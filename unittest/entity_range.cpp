@@ -400,4 +400,26 @@ TEST_CASE("entity_range ", "[entity]") {
 		// should not combine
 		tester({{0, 1}, {3, 4}, {6, 7}, {9, 10}}, {{0, 1}, {3, 4}, {6, 7}, {9, 10}});
 	}
+
+	SECTION("union of ranges") {
+		auto constexpr tester = [](std::vector<ecs::entity_range> a, std::vector<ecs::entity_range> const b,
+								   std::vector<ecs::entity_range> const expected) {
+			ecs::detail::union_ranges(a, b);
+			CHECK(a == expected);
+		};
+
+		tester({}, {}, {});
+		tester({}, {{0, 1}}, {{0, 1}});
+		tester({{0, 1}}, {}, {{0, 1}});
+
+		// disjoint ranges are interleaved
+		tester({{0, 1}, {10, 11}}, {{5, 6}, {20, 21}}, {{0, 1}, {5, 6}, {10, 11}, {20, 21}});
+
+		// overlapping and adjacent ranges are combined
+		tester({{0, 4}, {10, 14}}, {{3, 9}}, {{0, 14}});
+		tester({{0, 4}}, {{5, 6}, {7, 8}}, {{0, 8}});
+
+		// contained ranges are absorbed
+		tester({{0, 20}}, {{2, 3}, {5, 6}}, {{0, 20}});
+	}
 }
@@ -77,4 +77,48 @@ TEST_CASE("Filtering regression") {
 		rt.update();
 		SUCCEED();
 	}
-}
\ No newline at end of file
+}
+TEST_CASE("Filtering on scattered tags", "[component][system][tag]") {
+	struct every_2nd {
+		using ecs_flags = ecs::flags<ecs::tag>;
+	};
+	struct every_3rd {
+		using ecs_flags = ecs::flags<ecs::tag>;
+	};
+
+	ecs::runtime rt;
+	rt.add_component({0, 2999}, int());
+	rt.add_component({1000, 3999}, float());
+	for (int i = -30; i < 4000; i += 2)
+		rt.add_component(i, every_2nd{});
+	for (int i = 0; i < 4000; i += 3)
+		rt.add_component(i, every_3rd{});
+	rt.commit_changes();
+
+	// Count the expected entities
+	auto const count_if = [](auto pred) {
+		int count = 0;
+		for (int i = -30; i < 4000; i++)
+			count += pred(i) ? 1 : 0;
+		return count;
+	};
+	auto const has_int = [](int i) { return i >= 0 && i <= 2999; };
+	auto const has_float = [](int i) { return i >= 1000; };
+	auto const has_2nd = [](int i) { return i % 2 == 0; };
+	auto const has_3rd = [](int i) { return i >= 0 && i % 3 == 0; };
+
+	std::atomic_int with_tag = 0;
+	std::atomic_int without_tag = 0;
+	std::atomic_int both_tags = 0;
+	std::atomic_int mixed = 0;
+	rt.make_system([&with_tag](int const&, float const&, every_3rd) { with_tag++; });
+	rt.make_system([&without_tag](int const&, every_3rd*) { without_tag++; });
+	rt.make_system([&both_tags](every_2nd, every_3rd) { both_tags++; });
+	rt.make_system([&mixed](float const&, every_2nd, every_3rd*) { mixed++; });
+	rt.run_systems();
+
+	CHECK(with_tag == count_if([&](int i) { return has_int(i) && has_float(i) && has_3rd(i); }));
+	CHECK(without_tag == count_if([&](int i) { return has_int(i) && !has_3rd(i); }));
+	CHECK(both_tags == count_if([&](int i) { return has_2nd(i) && has_3rd(i); }));
+	CHECK(mixed == count_if([&](int i) { return has_float(i) && has_2nd(i) && !has_3rd(i); }));
+}
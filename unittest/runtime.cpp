@@ -1,12 +1,40 @@
 #include <ecs/ecs.h>
 #include <array>
+#include <execution>
+#include <filesystem>
+#include <memory>
+#include <memory_resource>
 #include <numeric>
+#include <string>
+#include <span>
+#include <thread>
+#include <utility>
 #include <exception>
 #include <catch2/catch_test_macros.hpp>
 
 // Override the default handler for contract violations.
 #include "override_contract_handler_to_throw.h"
 
+// Components stored in snapshots
+struct snap_tag {
+	using ecs_flags = ecs::flags<ecs::tag>;
+};
+struct snap_shared {
+	using ecs_flags = ecs::flags<ecs::share>;
+	int id;
+	bool operator==(snap_shared const&) const = default;
+};
+struct snap_global {
+	using ecs_flags = ecs::flags<ecs::global>;
+	int value = 0;
+};
+
+// Distinct component types for testing the pool index
+template <int N>
+struct numbered {
+	int value;
+};
+
 // A helper class that counts invocations of constructers/destructor
 struct runtime_ctr_counter {
 	inline static int def_ctr_count = 0;
@@ -140,6 +168,54 @@ TEST_CASE("The runtime interface") {
 #endif
 		}
 
+		SECTION("of move-only components works") {
+			struct move_only {
+				std::unique_ptr<int> p;
+			};
+
+			ecs::runtime rt;
+			rt.add_component(0, move_only{std::make_unique<int>(0)});
+
+			std::vector<move_only> vec;
+			for (int i = 1; i <= 4; i++)
+				vec.push_back(move_only{std::make_unique<int>(i)});
+			rt.add_component_span({1, 4}, std::move(vec));
+
+			std::array<move_only, 2> arr{move_only{std::make_unique<int>(5)}, move_only{std::make_unique<int>(6)}};
+			rt.add_component_span({5, 6}, std::move(arr));
+			rt.commit_changes();
+			REQUIRE(7 == rt.get_component_count<move_only>());
+
+			int sum = 0;
+			rt.make_system<ecs::opts::not_parallel>([&sum](move_only const& mo) { sum += *mo.p; });
+			rt.update();
+			REQUIRE(21 == sum);
+
+			// Only one entity at a time
+#ifndef __clang__
+			REQUIRE_THROWS(rt.add_component({7, 8}, move_only{}));
+#endif
+		}
+
+		SECTION("of adopted buffers works") {
+			ecs::unique_buffer<range_add> buffer(6);
+			for (int i = 0; i < 6; i++)
+				buffer.data()[i].i = i * 2;
+			range_add const* const data = buffer.data();
+
+			ecs::runtime rt;
+			rt.adopt_component_buffer({0, 5}, std::move(buffer));
+			rt.commit_changes();
+
+			REQUIRE(6 == rt.get_component_count<range_add>());
+			REQUIRE(data == rt.get_component<range_add>(0));
+			REQUIRE(10 == rt.get_component<range_add>(5)->i);
+
+#ifndef __clang__
+			REQUIRE_THROWS(rt.adopt_component_buffer({10, 15}, ecs::unique_buffer<range_add>(5)));
+#endif
+		}
+
 		SECTION("of components with generator works") {
 			ecs::runtime ecs;
 			auto const init = [](ecs::entity_id ent) -> range_add { return {ent * 2}; };
@@ -155,5 +231,483 @@ TEST_CASE("The runtime interface") {
 				i++;
 			}
 		}
+
+		SECTION("of components with parallel generator works") {
+			ecs::runtime ecs;
+			ecs.add_component_generator(std::execution::par, {0, 99'999}, [](ecs::entity_id ent) -> range_add { return {ent * 2}; });
+			ecs.commit_changes();
+
+			REQUIRE(100'000 == ecs.get_component_count<range_add>());
+			REQUIRE(2 * 99'999 == ecs.get_component<range_add>(99'999)->i);
+		}
+	}
+
+	SECTION("Memory resources") {
+		struct mem_res {
+			int i;
+		};
+
+		SECTION("are used to store components") {
+			std::array<std::byte, 1024> buffer;
+			std::pmr::monotonic_buffer_resource res(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+
+			ecs::runtime rt;
+			rt.set_memory_resource<mem_res>(&res);
+			REQUIRE(&res == rt.get_memory_resource<mem_res>());
+
+			rt.add_component({0, 9}, mem_res{3});
+			rt.commit_changes();
+
+			auto const* ptr = reinterpret_cast<std::byte const*>(rt.get_component<mem_res>(0));
+			REQUIRE(ptr >= buffer.data());
+			REQUIRE(ptr < buffer.data() + buffer.size());
+		}
+
+		SECTION("leaves room for internal tags in the data pointers") {
+			alignas(8) std::array<std::byte, 1024> buffer;
+			std::pmr::monotonic_buffer_resource res(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+			(void)res.allocate(1, 1); // misalign the next allocation
+
+			ecs::runtime rt;
+			rt.set_memory_resource<mem_res>(&res);
+			rt.add_component({0, 9}, mem_res{3});
+			rt.commit_changes();
+			rt.remove_component<mem_res>({4, 4}); // splits the chunk
+			rt.commit_changes();
+
+			REQUIRE(0 == reinterpret_cast<std::uintptr_t>(rt.get_component<mem_res>(0)) % sizeof(void*));
+			REQUIRE(3 == rt.get_component<mem_res>(9)->i);
+		}
+
+		SECTION("moves existing components when changed") {
+			std::array<std::byte, 1024> buffer;
+			std::pmr::monotonic_buffer_resource res(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+
+			ecs::runtime rt;
+			rt.add_component_generator({0, 9}, [](ecs::entity_id id) { return mem_res{id}; });
+			rt.commit_changes();
+			rt.remove_component<mem_res>({3, 5});
+			rt.commit_changes();
+
+			rt.set_memory_resource<mem_res>(&res);
+			for (ecs::entity_id id = 0; id <= 9; ++id) {
+				mem_res const* mr = rt.get_component<mem_res>(id);
+				if (id >= 3 && id <= 5) {
+					REQUIRE(nullptr == mr);
+				} else {
+					REQUIRE(id == mr->i);
+					auto const* ptr = reinterpret_cast<std::byte const*>(mr);
+					REQUIRE(ptr >= buffer.data());
+					REQUIRE(ptr < buffer.data() + buffer.size());
+				}
+			}
+
+			rt.reset_memory_resource<mem_res>();
+			REQUIRE(std::pmr::get_default_resource() == rt.get_memory_resource<mem_res>());
+			REQUIRE(9 == rt.get_component<mem_res>(9)->i);
+		}
+	}
+
+	SECTION("Modified components") {
+		struct dirty {
+			int i;
+		};
+
+		SECTION("only the ranges written to by systems are flagged") {
+			ecs::runtime rt;
+			rt.add_component({0, 99}, dirty{0});
+			rt.add_component({10, 19}, short{0});
+			rt.add_component({50, 59}, short{0});
+			rt.commit_changes();
+
+			std::vector<ecs::entity_range> const added{{0, 99}};
+			REQUIRE(std::ranges::equal(added, rt.get_modified_ranges<dirty>()));
+
+			auto& reader = rt.make_system<ecs::opts::manual_update>([](dirty const&) {});
+			auto& writer = rt.make_system<ecs::opts::manual_update>([](dirty& d, short const&) { d.i += 1; });
+
+			rt.commit_changes();
+			REQUIRE(rt.get_modified_ranges<dirty>().empty());
+
+			reader.run();
+			REQUIRE(rt.get_modified_ranges<dirty>().empty());
+
+			writer.run();
+			std::vector<ecs::entity_range> const written{{10, 19}, {50, 59}};
+			REQUIRE(std::ranges::equal(written, rt.get_modified_ranges<dirty>()));
+			REQUIRE(rt.get_modified_ranges<short>().empty());
+		}
+	}
+
+	SECTION("Defragmenting") {
+		struct defrag {
+			int i;
+		};
+
+		SECTION("keeps systems working") {
+			ecs::runtime rt;
+			rt.add_component_generator({0, 9}, [](ecs::entity_id id) { return defrag{id}; });
+			rt.commit_changes();
+			rt.add_component_generator({10, 19}, [](ecs::entity_id id) { return defrag{id}; });
+			rt.commit_changes();
+
+			int sum = 0;
+			auto& sys = rt.make_system<ecs::opts::manual_update, ecs::opts::not_parallel>([&sum](defrag const& d) { sum += d.i; });
+			sys.run();
+			REQUIRE(190 == sum);
+
+			ecs::defragment_result const result = rt.defragment<defrag>();
+			REQUIRE(1 == result.chunks_merged);
+			REQUIRE(rt.get_component<defrag>(0) + 19 == rt.get_component<defrag>(19));
+
+			sum = 0;
+			sys.run();
+			REQUIRE(190 == sum);
+		}
+	}
+
+	SECTION("Reserving memory") {
+		struct reserved {
+			int i;
+		};
+
+		ecs::runtime rt;
+		rt.reserve<reserved>({0, 19});
+		rt.add_component_generator({10, 19}, [](ecs::entity_id id) { return reserved{id}; });
+		rt.commit_changes();
+		rt.add_component_generator({0, 9}, [](ecs::entity_id id) { return reserved{id}; });
+		rt.commit_changes();
+
+		REQUIRE(rt.get_component<reserved>(0) + 19 == rt.get_component<reserved>(19));
+		REQUIRE(0 == rt.defragment<reserved>().chunks_merged);
+	}
+
+	SECTION("Component spans") {
+		ecs::runtime rt;
+		rt.add_component({0, 19}, int{1});
+		rt.commit_changes();
+		rt.add_component({20, 29}, int{3});
+		rt.commit_changes();
+
+		SECTION("have one span per chunk") {
+			std::vector<std::span<int>> spans;
+			for (std::span<int> const span : rt.get_component_spans<int>({5, 24}))
+				spans.push_back(span);
+
+			REQUIRE(2 == spans.size());
+			REQUIRE(15 == spans[0].size());
+			REQUIRE(5 == spans[1].size());
+			REQUIRE(rt.get_component<int>(5) == spans[0].data());
+			REQUIRE(rt.get_component<int>(20) == spans[1].data());
+			REQUIRE(3 == spans[1].front());
+		}
+
+		SECTION("join split chunks that share memory") {
+			rt.remove_component<int>({4, 5});
+			rt.commit_changes();
+			rt.add_component({4, 5}, int{4});
+			rt.commit_changes();
+
+			auto const view = rt.get_component_spans<int>({0, 9});
+			REQUIRE(1 == std::ranges::distance(view));
+			REQUIRE(10 == (*view.begin()).size());
+			REQUIRE(4 == (*view.begin())[5]);
+		}
+
+		SECTION("are empty if an entity does not have the component") {
+			REQUIRE(rt.get_component_spans<int>({25, 35}).empty());
+			REQUIRE(rt.get_component_spans<short>({0, 9}).empty());
+		}
+	}
+
+	SECTION("Component types are indexed") {
+		std::size_t const index = ecs::detail::get_type_index<numbered<0>>();
+		REQUIRE(index == ecs::detail::get_type_index<numbered<0>>());
+		REQUIRE(index != ecs::detail::get_type_index<numbered<1>>());
+		REQUIRE(ecs::detail::type_index_counter > index);
+
+		ecs::runtime rt;
+		[&rt]<int... N>(std::integer_sequence<int, N...>) {
+			(rt.add_component(N, numbered<N>{N}), ...);
+			rt.commit_changes();
+
+			REQUIRE(((1 == rt.get_component_count<numbered<N>>()) && ...));
+			REQUIRE(((N == rt.get_component<numbered<N>>(N)->value) && ...));
+		}(std::make_integer_sequence<int, 4>{});
+	}
+
+	SECTION("Shared components") {
+		struct material {
+			using ecs_flags = ecs::flags<ecs::share>;
+			int id;
+			bool operator==(material const&) const = default;
+		};
+		struct mesh {
+			int id;
+		};
+
+		SECTION("are read by systems and changed with set_shared_component") {
+			ecs::runtime rt;
+			rt.add_component({0, 9}, material{1}, mesh{0});
+			rt.add_component({10, 19}, material{2}, mesh{0});
+			rt.commit_changes();
+			REQUIRE(2 == rt.get_component_count<material>());
+
+			int sum = 0;
+			auto& sys = rt.make_system<ecs::opts::manual_update, ecs::opts::not_parallel>([&sum](mesh const&, material const& m) { sum += m.id; });
+			sys.run();
+			REQUIRE(30 == sum);
+
+			rt.set_shared_component({5, 14}, material{3});
+			rt.commit_changes();
+			REQUIRE(3 == rt.get_component_count<material>());
+			REQUIRE(1 == rt.get_component<material>(4)->id);
+			REQUIRE(3 == rt.get_component<material>(5)->id);
+			REQUIRE(2 == rt.get_component<material>(15)->id);
+
+			sum = 0;
+			sys.run();
+			REQUIRE(5 * 1 + 10 * 3 + 5 * 2 == sum);
+		}
+	}
+
+	SECTION("Memory report") {
+		SECTION("lists the memory used by each type of component") {
+			ecs::runtime rt;
+			rt.add_component({0, 9}, int{0});
+			rt.add_component({20, 29}, int{0});
+			rt.add_component({0, 4}, short{0});
+			rt.commit_changes();
+
+			auto const reports = rt.memory_report();
+			REQUIRE(2 == reports.size());
+
+			ecs::component_memory_report const& ints = reports[0];
+			REQUIRE(ints.name == "int");
+			REQUIRE(20 == ints.num_entities);
+			REQUIRE(2 == ints.num_chunks);
+			REQUIRE(0 == ints.num_split_chunks);
+			REQUIRE(10.0 == ints.average_run_length);
+			REQUIRE(20 * sizeof(int) == ints.bytes_live);
+			REQUIRE(ints.bytes_allocated >= ints.bytes_live);
+			REQUIRE(ints.bytes_bookkeeping > 0);
+
+			REQUIRE(reports[1].name.starts_with("short"));
+			REQUIRE(5 == reports[1].num_entities);
+		}
+
+		SECTION("counts split chunks and lookups") {
+			ecs::runtime rt;
+			rt.add_component({0, 9}, int{0});
+			rt.commit_changes();
+			rt.remove_component<int>({4, 5});
+			rt.commit_changes();
+
+			for (ecs::entity_id id = 0; id < 10; ++id)
+				rt.get_component<int>(id);
+
+			auto const reports = rt.memory_report();
+			REQUIRE(1 == reports[0].num_split_chunks);
+			REQUIRE(10 * sizeof(int) == reports[0].bytes_allocated);
+			REQUIRE(8 * sizeof(int) == reports[0].bytes_unused() + 6 * sizeof(int));
+#if ECS_ENABLE_LOOKUP_STATS
+			REQUIRE(reports[0].lookup_hit_rate > 0.5f);
+			REQUIRE(reports[0].lookup_hit_rate < 1.0f);
+#else
+			REQUIRE(0.0f == reports[0].lookup_hit_rate);
+#endif
+		}
+	}
+
+	SECTION("Snapshots") {
+		auto const path = std::filesystem::temp_directory_path() / "ecs_runtime_snapshot.bin";
+
+		SECTION("restore the components of trivially copyable types") {
+			{
+				ecs::runtime rt;
+				rt.add_component({0, 9}, int{3}, snap_shared{1});
+				rt.add_component({20, 29}, int{4}, snap_tag{}, snap_shared{2});
+				rt.add_component({0, 4}, std::string{"not stored"});
+				rt.get_global_component<snap_global>().value = 42;
+				rt.commit_changes();
+				rt.remove_component<int>({5, 6});
+				rt.commit_changes();
+				REQUIRE(rt.save_snapshot(path));
+			}
+
+			ecs::runtime rt;
+			int sum = 0;
+			auto& sys = rt.make_system<ecs::opts::manual_update, ecs::opts::not_parallel>([&sum](int const& i) { sum += i; });
+			rt.add_component({100, 109}, int{0});
+			rt.commit_changes();
+
+			REQUIRE(rt.load_snapshot<snap_tag, snap_shared, snap_global>(path));
+			REQUIRE(18 == rt.get_component_count<int>());
+			REQUIRE(rt.get_component<int>(100) == nullptr);
+			REQUIRE(3 == *rt.get_component<int>(7));
+			REQUIRE(4 == *rt.get_component<int>(25));
+			REQUIRE(10 == rt.get_entity_count<snap_tag>());
+			REQUIRE(rt.has_component<snap_tag>(29));
+			REQUIRE(2 == rt.get_component<snap_shared>(21)->id);
+			REQUIRE(2 == rt.get_component_count<snap_shared>());
+			REQUIRE(42 == rt.get_global_component<snap_global>().value);
+
+			sys.run();
+			REQUIRE(8 * 3 + 10 * 4 == sum);
+			std::filesystem::remove(path);
+		}
+
+		SECTION("fail to load types without a pool") {
+			{
+				ecs::runtime rt;
+				rt.add_component({0, 9}, int{3}, snap_shared{1});
+				rt.commit_changes();
+				REQUIRE(rt.save_snapshot(path));
+			}
+
+			ecs::runtime rt;
+			rt.add_component({0, 9}, int{3});
+			rt.commit_changes();
+			REQUIRE(!rt.load_snapshot(path));
+			REQUIRE(0 == rt.get_component_count<int>());
+			REQUIRE(!rt.load_snapshot(path.string() + ".missing"));
+			std::filesystem::remove(path);
+		}
+	}
+
+	SECTION("Command buffers") {
+		SECTION("are applied in bulk on commit") {
+			ecs::runtime rt;
+			rt.add_component({0, 9}, short{1});
+			rt.commit_changes();
+
+			// Record from several threads, each into its own buffer
+			std::vector<std::thread> threads;
+			for (int t = 0; t < 4; t++) {
+				threads.emplace_back([&rt, t] {
+					ecs::command_buffer cmds;
+					for (int i = 9; i >= 0; i--)
+						cmds.add_component(t * 100 + i, int{t});
+					REQUIRE(10 == cmds.size());
+					rt.submit(std::move(cmds));
+					REQUIRE(cmds.empty());
+				});
+			}
+			for (auto& thread : threads)
+				thread.join();
+
+			ecs::command_buffer cmds;
+			cmds.remove_component<short>({0, 4});
+			cmds.add_component(1000, int{5}, runtime_ctr_counter{});
+			rt.submit(std::move(cmds));
+
+			REQUIRE(0 == rt.get_component_count<int>());
+			rt.commit_changes();
+			REQUIRE(41 == rt.get_component_count<int>());
+			REQUIRE(1 == rt.get_component_count<runtime_ctr_counter>());
+			REQUIRE(5 == rt.get_component_count<short>());
+			REQUIRE(4 == rt.get_entity_count<int>() / 10);
+			REQUIRE(3 == *rt.get_component<int>(305));
+			REQUIRE(!rt.has_component<short>(4));
+		}
+	}
+
+	SECTION("Entity creation") {
+		SECTION("hands out contiguous ranges") {
+			ecs::runtime rt;
+			ecs::entity_range const a = rt.create_entities(10);
+			ecs::entity_range const b = rt.create_entities(5);
+			REQUIRE(a == ecs::entity_range{0, 9});
+			REQUIRE(b == ecs::entity_range{10, 14});
+			REQUIRE(15 == rt.get_created_entity_count());
+		}
+
+		SECTION("reuses the smallest gap that fits") {
+			ecs::runtime rt;
+			rt.create_entities(100);
+			rt.destroy_entities({10, 29}); // gap of 20
+			rt.destroy_entities({50, 54}); // gap of 5
+			rt.destroy_entities({90, 99}); // ids at the end are given back
+			REQUIRE(65 == rt.get_created_entity_count());
+
+			rt.commit_changes();
+
+			REQUIRE(rt.create_entities(4) == ecs::entity_range{50, 53});
+			REQUIRE(rt.create_entities(8) == ecs::entity_range{10, 17});
+			REQUIRE(rt.create_entities(20) == ecs::entity_range{90, 109});
+
+			// Destroyed ranges are merged with the gaps next to them
+			rt.destroy_entities({50, 53});
+			rt.commit_changes();
+			REQUIRE(rt.create_entities(5) == ecs::entity_range{50, 54});
+		}
+
+		SECTION("destroying entities removes components that are not committed yet") {
+			ecs::runtime rt;
+			ecs::entity_range const ents = rt.create_entities(10);
+			rt.add_component(ents, int{1});
+			rt.add_component_generator({2, 7}, [](ecs::entity_id id) { return short(id); });
+			rt.destroy_entities({0, 4});
+
+			// The ids are not reused before the commit
+			REQUIRE(rt.create_entities(1) == ecs::entity_range{10, 10});
+			rt.destroy_entities({10, 10});
+			rt.commit_changes();
+			REQUIRE(5 == rt.get_component_count<int>());
+			REQUIRE(3 == rt.get_component_count<short>());
+			REQUIRE(!rt.has_component<int>(0));
+
+			// The recycled ids have no components
+			ecs::entity_range const recycled = rt.create_entities(5);
+			REQUIRE(recycled == ecs::entity_range{0, 4});
+			for (ecs::entity_id const id : recycled) {
+				REQUIRE(!rt.has_component<int>(id));
+				REQUIRE(!rt.has_component<short>(id));
+			}
+		}
+
+		SECTION("destroying entities removes their components") {
+			ecs::runtime rt;
+			ecs::entity_range const ents = rt.create_entities(10);
+			rt.add_component(ents, int{1}, short{2});
+			rt.add_component({0, 4}, char{3});
+			rt.commit_changes();
+
+			rt.destroy_entities({3, 6});
+			rt.commit_changes();
+			REQUIRE(6 == rt.get_entity_count<int>());
+			REQUIRE(6 == rt.get_entity_count<short>());
+			REQUIRE(3 == rt.get_entity_count<char>());
+
+			// The recycled ids fill the gap, so the components are stored in one chunk again
+			ecs::entity_range const refill = rt.create_entities(4);
+			REQUIRE(refill == ecs::entity_range{3, 6});
+			rt.add_component(refill, int{1});
+			rt.commit_changes();
+			REQUIRE(rt.get_components<int>(ents).size() == 10);
+		}
+
+		SECTION("are restored by snapshots") {
+			auto const path = std::filesystem::temp_directory_path() / "ecs_runtime_entity_snapshot.bin";
+			{
+				ecs::runtime rt;
+				rt.add_component(rt.create_entities(10), int{1});
+				rt.destroy_entities({2, 3});
+				rt.commit_changes();
+				REQUIRE(rt.save_snapshot(path));
+			}
+
+			ecs::runtime rt;
+			rt.create_entities(50);
+			REQUIRE(rt.load_snapshot<int, float>(path));
+			REQUIRE(8 == rt.get_created_entity_count());
+			REQUIRE(rt.create_entities(2) == ecs::entity_range{2, 3});
+			REQUIRE(rt.create_entities(1) == ecs::entity_range{10, 10});
+
+			// A failed load forgets the entities along with the components
+			std::filesystem::remove(path);
+			REQUIRE(!rt.load_snapshot(path));
+			REQUIRE(0 == rt.get_created_entity_count());
+		}
 	}
 }
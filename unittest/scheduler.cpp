@@ -8,6 +8,11 @@ using namespace std::chrono_literals;
 template <size_t I>
 struct type {};
 
+struct double_buffered_counter {
+	using ecs_flags = ecs::flags<ecs::double_buffer>;
+	int value;
+};
+
 // Tests to make sure the scheduler works as intended.
 TEST_CASE("Scheduler") {
 	SECTION("verify wide dependency chains work") {
@@ -103,4 +108,40 @@ TEST_CASE("Scheduler") {
 		CHECK(sys5 == true);
 		CHECK(sys6 == true);
 	}
+
+	SECTION("Double-buffered components are read from the previous cycle") {
+		ecs::runtime ecs;
+
+		std::atomic_int seen_by_reader = -1;
+		std::atomic_int seen_by_second_writer = -1;
+
+		ecs.make_system([](double_buffered_counter& c) {
+			c.value += 1;
+		});
+
+		// Does not depend on the writer, so it sees the value from before the writer ran
+		ecs.make_system([&seen_by_reader](double_buffered_counter const& c) {
+			seen_by_reader = c.value;
+		});
+
+		// Writers still depend on each other, so it sees the first writers value
+		ecs.make_system([&seen_by_second_writer](double_buffered_counter& c) {
+			seen_by_second_writer = c.value;
+			c.value *= 2;
+		});
+
+		ecs.add_component(0, double_buffered_counter{0});
+		ecs.commit_changes();
+
+		int expected = 0;
+		for (int i = 0; i < 5; i++) {
+			ecs.run_systems();
+			CHECK(expected == seen_by_reader);
+			CHECK(expected + 1 == seen_by_second_writer);
+
+			expected = (expected + 1) * 2;
+			CHECK(expected == ecs.get_component<double_buffered_counter>(0)->value);
+			ecs.commit_changes();
+		}
+	}
 }
@@ -16,7 +16,7 @@ TEST_CASE("Sorting") {
 	std::mt19937 gen{rd()};
 	std::shuffle(ints.begin(), ints.end(), gen);
 
-	ecs.add_component({1, num_components}, ints);
+	ecs.add_component_span({1, num_components}, ints);
 	ecs.commit_changes();
 
 	unsigned test = std::numeric_limits<unsigned>::min();
@@ -48,4 +48,18 @@ TEST_CASE("Sorting") {
 
 	test = std::numeric_limits<unsigned>::max();
 	dec.run();
+
+	// modify a few of the components and re-check
+	ecs.add_component({1, 100}, short{0});
+	ecs.commit_changes();
+	auto& mod_some = ecs.make_system<ecs::opts::not_parallel, ecs::opts::manual_update>([&gen](unsigned& i, short const&) {
+		i = gen();
+	});
+	mod_some.run();
+
+	test = std::numeric_limits<unsigned>::min();
+	asc.run();
+
+	test = std::numeric_limits<unsigned>::max();
+	dec.run();
 }
\ No newline at end of file
@@ -149,6 +149,47 @@ TEST_CASE("System specification", "[system]") {
 		ecs.update(); // transient component is gone, so system wont run
 		CHECK(run_counter == 1001 - 11);
 	}
+	SECTION("Systems can use soa components") {
+		ecs::runtime ecs;
+
+		struct soa_vel {
+			using ecs_flags = ecs::flags<ecs::soa>;
+			float x, y;
+		};
+		struct soa_pos {
+			using ecs_flags = ecs::flags<ecs::soa>;
+			float x, y;
+		};
+
+		auto& sys_move = ecs.make_system<ecs::opts::manual_update>([](ecs::soa_ref<soa_pos> pos, ecs::soa_ref<soa_vel const> vel) {
+			auto [x, y] = pos;
+			auto const [vx, vy] = vel;
+			x += vx;
+			y += vy;
+		});
+		auto& sys_reset = ecs.make_system<ecs::opts::manual_update>([](ecs::entity_id id, ecs::soa_ref<soa_vel> vel) {
+			vel = soa_vel{static_cast<float>(id), 1};
+		});
+
+		CHECK(sys_move.writes_to_component(ecs::detail::get_type_hash<soa_pos>()));
+		CHECK(!sys_move.writes_to_component(ecs::detail::get_type_hash<soa_vel>()));
+		CHECK(sys_reset.writes_to_component(ecs::detail::get_type_hash<soa_vel>()));
+		CHECK(sys_move.depends_on(&sys_reset));
+
+		ecs.add_component({0, 99}, soa_pos{0, 0}, soa_vel{0, 0});
+		ecs.commit_changes();
+
+		sys_reset.run();
+		sys_move.run();
+		sys_move.run();
+
+		for (int i = 0; i < 100; i++) {
+			soa_pos const pos = ecs.get_component<soa_pos>(i);
+			REQUIRE(pos.x == 2.0f * static_cast<float>(i));
+			REQUIRE(pos.y == 2.0f);
+		}
+	}
+
 	SECTION("Adding components during a system run works") {
 		// Added this test in response to a bug found by https://github.com/relick
 
@@ -1,4 +1,5 @@
 #include <ecs/ecs.h>
+#include <vector>
 #include <catch2/catch_test_macros.hpp>
 
 TEST_CASE("System options tests") {
@@ -16,4 +17,60 @@ TEST_CASE("System options tests") {
 		test_sys.run();
 		REQUIRE(counter == 1);
 	}
+
+	SECTION("opts::changed only visits changed components") {
+		ecs::runtime ecs;
+		ecs.add_component({0, 99}, int{0});
+		ecs.add_component({10, 19}, short{0});
+		ecs.commit_changes();
+
+		std::vector<ecs::entity_id> visited;
+		auto& changed_sys = ecs.make_system<ecs::opts::manual_update, ecs::opts::not_parallel, ecs::opts::changed<int>>(
+			[&visited](ecs::entity_id id, int const&) { visited.push_back(id); });
+		auto& writer = ecs.make_system<ecs::opts::manual_update, ecs::opts::not_parallel>([](int& i, short const&) { i += 1; });
+
+		// All the components are new
+		changed_sys.run();
+		REQUIRE(visited.size() == 100);
+
+		// Nothing has changed since the last run
+		visited.clear();
+		changed_sys.run();
+		REQUIRE(visited.empty());
+
+		// Changes are seen across commits
+		writer.run();
+		ecs.commit_changes();
+		changed_sys.run();
+		REQUIRE(visited.size() == 10);
+		REQUIRE(visited.front() == 10);
+		REQUIRE(visited.back() == 19);
+
+		// New components are seen as changed
+		visited.clear();
+		ecs.add_component(200, int{0});
+		ecs.commit_changes();
+		changed_sys.run();
+		REQUIRE(visited.size() == 1);
+		REQUIRE(visited.front() == 200);
+	}
+
+	SECTION("opts::changed does not see the systems own changes") {
+		ecs::runtime ecs;
+		ecs.add_component({0, 99}, int{0});
+		ecs.commit_changes();
+
+		int counter = 0;
+		auto& changed_sys = ecs.make_system<ecs::opts::manual_update, ecs::opts::not_parallel, ecs::opts::changed<int>>(
+			[&counter](int& i) {
+				i += 1;
+				counter += 1;
+			});
+
+		changed_sys.run();
+		REQUIRE(counter == 100);
+
+		changed_sys.run();
+		REQUIRE(counter == 100);
+	}
 }
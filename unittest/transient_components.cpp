@@ -37,3 +37,36 @@ TEST_CASE("Transient components", "[component][transient]") {
 	// No transient components should be active
 	CHECK(0ULL == ecs.get_component_count<test_t>());
 }
+
+TEST_CASE("Transient components reuse their memory", "[component][transient]") {
+	ecs::runtime ecs;
+
+	struct damage {
+		using ecs_flags = ecs::flags<ecs::transient>;
+		int value;
+	};
+
+	int total = 0;
+	ecs.make_system<ecs::opts::not_parallel>([&total](damage const& d) { total += d.value; });
+
+	for (int i = 0; i < 10; i++) {
+		ecs.add_component({0, 9}, damage{1});
+		ecs.add_component({20, 29}, damage{1});
+		ecs.update();
+		ecs.update(); // removes the components
+	}
+	CHECK(200 == total);
+
+	// Only the first cycle needs to allocate memory
+	float const rate = ecs.get_memory_reuse_rate<damage>();
+	CHECK(rate >= 0.9f);
+
+	// Using more memory than the previous cycles grows the arena
+	for (int i = 0; i < 2; i++) {
+		ecs.add_component({0, 99}, damage{1});
+		ecs.update();
+		ecs.update();
+	}
+	CHECK(400 == total);
+	CHECK(ecs.get_memory_reuse_rate<damage>() < rate);
+}